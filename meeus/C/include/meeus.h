@@ -1,24 +1,41 @@
 #ifndef _MEEUS_H
 #define _MEEUS_H
 
+#include <stddef.h>
+#include <stdio.h>
+#include <stdint.h>
+
 /* errors */
 typedef enum meeus_error_e
 {
     M_NO_ERR = 0,
-    M_INVALID_RANGE_ERR
+    M_INVALID_RANGE_ERR,
+    M_IO_ERR,
+    M_FORMAT_ERR,
+    M_NO_MEM_ERR
 } m_err_t;
 
 /* accuracy */
 typedef enum meeus_accuracy_e
 {
     M_LOW_ACC = 0,
-    M_HIGH_ACC
+    M_HIGH_ACC,
+    M_MED_ACC                   /* Sun functions: truncated VSOP87, years 1900 to 2100 */
 } m_acc_t;
 
 /* math */
-#define sind(x) sin((x)/180.0*M_PI)
-#define cosd(x) cos((x)/180.0*M_PI)
-#define tand(x) tan((x)/180.0*M_PI)
+/* trigonometry in degrees */
+double m_sind (double x);
+double m_cosd (double x);
+double m_tand (double x);
+void m_sincosd (double x, double *s, double *c);
+double m_atan2d (double y, double x);
+double m_asind (double x);
+void m_sincosd_batch (const double *restrict x, size_t n,
+                      double *restrict s, double *restrict c);
+void m_atan2d_batch (const double *restrict y, const double *restrict x,
+                     size_t n, double *restrict r);
+void m_asind_batch (const double *restrict x, size_t n, double *restrict r);
 
 #define rad_to_deg(x) ((x)*180.0/M_PI)
 #define deg_to_rad(x) ((x)*M_PI/180.0)
@@ -61,6 +78,8 @@ enum planet_e
 double polynom (const double *coef, double v, int order);
 double get_century_since_j2000 (double jd);
 double rerange (double v, double mod);
+/* cubic interpolation of the values y[-1] .. y[2] at 0 <= x < 1 */
+double interp4 (const double *y, double x);
 void s_to_hms (double seconds, int *h, int *m, double *s);
 double fround (double v, int n);
 #define arcs_to_dms s_to_hms
@@ -70,8 +89,53 @@ double fround (double v, int n);
 m_err_t dt_date_to_jd (struct tm *date, double *jd);
 m_err_t dt_jd_to_date (double jd, struct tm *date);
 m_err_t dt_get_current_jd (int is_local, double *jd);
+/* two-part julian day: JD = day + frac, 0 <= frac < 1 */
+struct dt_jd2_s
+{
+    long day;
+    double frac;
+};
+m_err_t dt_get_current_jd2 (int is_local, struct dt_jd2_s *jd);
+struct dt_clock_s
+{
+    struct timespec mono;
+    struct dt_jd2_s anchor;
+    double resync;
+    int is_local;
+};
+m_err_t dt_clock_init (struct dt_clock_s *clk, int is_local, double resync);
+m_err_t dt_clock_get_jd2 (struct dt_clock_s *clk, struct dt_jd2_s *jd);
 m_err_t dt_get_day_of_week (struct tm *date, int *dow);
 m_err_t dt_get_day_of_year (struct tm *date, int *doy);
+m_err_t dt_date_to_jd_batch (const int *restrict year,
+                             const int *restrict month,
+                             const int *restrict day,
+                             const double *restrict secs, size_t n,
+                             double *restrict jd,
+                             unsigned char *restrict err);
+m_err_t dt_jd_to_date_batch (const double *restrict jd, size_t n,
+                             int *restrict year, int *restrict month,
+                             int *restrict day, double *restrict secs,
+                             unsigned char *restrict err);
+
+/* integer timestamps: nanoseconds since J2000.0 */
+typedef int64_t m_time_t;
+#define MT_JD_EPOCH 2451545.0
+#define MT_NS_PER_DAY 86400000000000LL
+/* m_time_t range in days on each side of J2000.0 */
+#define MT_MAX_DAYS 106750
+m_err_t mt_from_jd (double jd, m_time_t *t);
+m_err_t mt_from_jd2 (const struct dt_jd2_s *jd, m_time_t *t);
+double mt_to_jd (m_time_t t);
+void mt_to_jd2 (m_time_t t, struct dt_jd2_s *jd);
+m_err_t mt_to_date (m_time_t t, struct tm *date);
+m_err_t mt_get_current_time (m_time_t *t);
+m_time_t mt_ut_to_dt (m_time_t t);
+m_time_t mt_dt_to_ut (m_time_t t);
+
+/* ISO 8601 strings */
+m_err_t iso_parse (const char *s, size_t len, double *jd, size_t *consumed);
+m_err_t iso_format (double jd, int frac_digits, char *buf, size_t size);
 
 /* calendar */
 m_err_t cal_get_easter (int year, int *month, int *day);
@@ -80,15 +144,73 @@ m_err_t cal_get_1_tishri (int year, int *jyear, int *month, int *day);
 m_err_t cal_get_jewish_year_type (int jyear, int *is_leap, int *ndays);
 
 /* dynamical time */
+typedef enum dy_deltaT_source_e
+{
+    DY_SRC_POLYNOMIAL = 0,
+    DY_SRC_TABLE
+} dy_src_t;
+void dy_set_deltaT_source (dy_src_t source);
 double dy_get_deltaT_seconds (double jde);
 double dy_dt_to_ut (double jde);
 double dy_ut_to_dt (double jd);
 #define jd_to_jde dy_ut_to_dt
 #define jde_to_jd dy_dt_to_ut
 
+/* observed Earth orientation data */
+typedef enum eop_format_e
+{
+    EOP_FMT_USNO_DELTAT = 0,
+    EOP_FMT_IERS_FINALS
+} eop_fmt_t;
+m_err_t eop_compile (const char *txt_path, eop_fmt_t format, double step,
+                     const char *bin_path);
+m_err_t eop_load (const char *bin_path);
+void eop_unload (void);
+void eop_synchronize (void);
+m_err_t eop_get_deltaT_seconds (double jd, double *deltaT);
+m_err_t eop_get_ut1_utc_seconds (double jd, double *dut1);
+
+/* time scales */
+#define TS_JD_1972 2441317.5
+double ts_get_tai_utc (double jd);
+m_err_t ts_utc_to_tai (double jd_utc, double *jd_tai);
+m_err_t ts_tai_to_utc (double jd_tai, double *jd_utc);
+double ts_tai_to_tt (double jd_tai);
+double ts_tt_to_tai (double jde);
+double ts_get_tdb_tt (double jde);
+double ts_tt_to_tdb (double jde);
+double ts_tdb_to_tt (double jde);
+m_err_t ts_utc_to_tt (double jd_utc, double *jde);
+m_err_t ts_tt_to_utc (double jde, double *jd_utc);
+m_err_t ts_utc_to_tt_batch (const double *restrict jd_utc, size_t n,
+                            double *restrict jde,
+                            unsigned char *restrict err);
+m_err_t ts_tt_to_utc_batch (const double *restrict jde, size_t n,
+                            double *restrict jd_utc,
+                            unsigned char *restrict err);
+void ts_tt_to_tdb_batch (const double *restrict jde, size_t n,
+                         double *restrict jde_tdb);
+
 /* sidereal time */
 m_err_t sid_get_mean_gw_sid_time (double jd, double *sid_t);
 m_err_t sid_get_apparent_gw_sid_time (double jd, double *sid_t);
+m_err_t sid_get_mean_gw_sid_time_mt (m_time_t t, double *sid_t);
+m_err_t sid_get_apparent_gw_sid_time_mt (m_time_t t, double *sid_t);
+struct sid_stepper_s
+{
+    m_time_t step;              /* time between steps, ns */
+    m_time_t refresh;           /* interval between anchors, ns */
+    m_time_t anchor;            /* time of the anchor, ns */
+    int64_t k;                  /* steps since the anchor */
+    double anchor_mst;          /* linear part of mean sidereal time at the anchor, degrees */
+    double anchor_T;            /* Julian centuries since J2000.0 at the anchor */
+    double eqeq;                /* equation of the equinoxes at the anchor, seconds */
+    int is_apparent;
+};
+m_err_t sid_stepper_init (struct sid_stepper_s *st, m_time_t t0,
+                          m_time_t step, m_time_t refresh, int is_apparent);
+m_err_t sid_stepper_next (struct sid_stepper_s *st, m_time_t *t,
+                          double *sid_t);
 
 /* Coordinates */
 void coo_equ_to_ecl (double alpha, double delta, double epsilon,
@@ -102,12 +224,157 @@ void
 coo_hor_to_equ (double A, double h, double phi, double *H, double *delta);
 m_err_t coo_get_local_hour_angle (double jd, double L, double alpha,
                                   double *hour_angle, int is_apparent);
+m_err_t coo_get_local_hour_angle_mt (m_time_t t, double L, double alpha,
+                                     double *hour_angle, int is_apparent);
+double coo_get_local_hour_angle_sid (double sid_t, double L, double alpha);
+void coo_equ_to_ecl_batch (const double *alpha, const double *delta,
+                           size_t n, double epsilon, double *lambda,
+                           double *beta);
+void coo_ecl_to_equ_batch (const double *lambda, const double *beta,
+                           size_t n, double epsilon, double *alpha,
+                           double *delta);
+void coo_equ_to_hor_batch (const double *H, const double *delta, size_t n,
+                           double phi, double *A, double *h);
+void coo_hor_to_equ_batch (const double *A, const double *h, size_t n,
+                           double phi, double *H, double *delta);
+m_err_t coo_get_local_hour_angle_batch (double jd, double L,
+                                        const double *alpha, size_t n,
+                                        double *hour_angle, int is_apparent);
+m_err_t coo_equ_to_hor_matrix (double jd, const double *L, const double *phi,
+                               size_t n_obs, const double *alpha,
+                               const double *delta, size_t n_obj,
+                               int is_apparent, int nthreads, double *A,
+                               double *h);
+
+/* parallax */
+struct plx_site_s
+{
+    double phi1;                /* geocentric latitude, degrees */
+    double rho_sin;             /* rho sin (phi'), in equatorial radii */
+    double rho_cos;             /* rho cos (phi'), in equatorial radii */
+};
+void plx_site_init (double phi, double height, struct plx_site_s *site);
+void plx_equ_to_topo (const struct plx_site_s *site, double H, double alpha,
+                      double delta, double dist, double *alpha_t,
+                      double *delta_t);
+void plx_equ_to_topo_batch (const struct plx_site_s *site, const double *H,
+                            const double *alpha, const double *delta,
+                            const double *dist, size_t n, double *alpha_t,
+                            double *delta_t);
+
+/* rotation matrices */
+struct rot_mat_s
+{
+    double m[3][3];
+};
+void rot_ecl_to_equ (double epsilon, struct rot_mat_s *r);
+void rot_equ_to_hor (double theta, double phi, struct rot_mat_s *r);
+m_err_t rot_get_equ_to_hor (double jd, double L, double phi, int is_apparent,
+                            struct rot_mat_s *r);
+void rot_ecl_to_hor (double epsilon, double theta, double phi,
+                     struct rot_mat_s *r);
+void rot_precession (double jde, struct rot_mat_s *r);
+m_err_t rot_nutation (double jde, m_acc_t accuracy, struct rot_mat_s *r);
+void rot_mul (const struct rot_mat_s *a, const struct rot_mat_s *b,
+              struct rot_mat_s *r);
+void rot_transpose (const struct rot_mat_s *a, struct rot_mat_s *r);
+void rot_sph_to_vec (const double *restrict lon, const double *restrict lat,
+                     size_t n, double *restrict x, double *restrict y,
+                     double *restrict z);
+void rot_apply (const struct rot_mat_s *r, const double *restrict x,
+                const double *restrict y, const double *restrict z, size_t n,
+                double *restrict xo, double *restrict yo,
+                double *restrict zo);
+void rot_vec_to_sph (const double *restrict x, const double *restrict y,
+                     const double *restrict z, size_t n,
+                     double *restrict lon, double *restrict lat);
+
+/* parallel loops */
+typedef void (*thr_fn_t) (size_t begin, size_t end, void *ctx);
+int thr_get_nprocs (void);
+void thr_for (size_t n, size_t grain, int nthreads, thr_fn_t fn, void *ctx);
+
+/* star catalogs */
+struct cat_s
+{
+    void *map;
+    size_t map_len;
+    size_t count;               /* number of stars */
+    double epoch;               /* epoch of the positions (JDE) */
+    const int64_t *id;
+    const double *x, *y, *z;    /* unit vectors, mean equator and equinox of J2000.0 */
+    const double *vx, *vy, *vz; /* proper motions, radians per Julian year */
+    const double *mag;
+};
+struct cat_epoch_s
+{
+    double t;                   /* Julian years since J2000.0 */
+    struct rot_mat_s m;         /* precession and nutation */
+    double v[3];                /* Earth velocity / c, equator of date */
+};
+m_err_t cat_compile (const char *txt_path, const char *bin_path);
+m_err_t cat_open (const char *bin_path, struct cat_s *cat);
+void cat_close (struct cat_s *cat);
+m_err_t cat_get_epoch (double jde, struct cat_epoch_s *ep);
+void cat_apparent_vec (const struct cat_s *cat, const struct cat_epoch_s *ep,
+                       int nthreads, double *x, double *y, double *z);
+void cat_apparent_place (const struct cat_s *cat,
+                         const struct cat_epoch_s *ep, int nthreads,
+                         double *alpha, double *delta);
+
+/* spatial index */
+struct spi_s
+{
+    size_t n;                   /* number of points */
+    double *x, *y, *z;          /* unit vectors, sorted by key */
+    uint64_t *key;              /* cube face and Morton code of the cell */
+    size_t *id;                 /* index of the points in the input arrays */
+};
+typedef void (*spi_fn_t) (size_t id, double cos_sep, void *ctx);
+typedef void (*spi_pair_fn_t) (size_t i, size_t j, double cos_sep,
+                               void *ctx);
+m_err_t spi_build (const double *x, const double *y, const double *z,
+                   size_t n, struct spi_s *idx);
+m_err_t spi_build_cat (const struct cat_s *cat, struct spi_s *idx);
+void spi_free (struct spi_s *idx);
+size_t spi_cone (const struct spi_s *idx, const struct rot_mat_s *r,
+                 const double *c, double radius, spi_fn_t fn, void *ctx);
+size_t spi_knn (const struct spi_s *idx, const struct rot_mat_s *r,
+                const double *c, size_t k, size_t *id, double *sep);
+size_t spi_pairs (const struct spi_s *idx, double theta, spi_pair_fn_t fn,
+                  void *ctx);
+size_t spi_visible (const struct spi_s *idx, const struct rot_mat_s *r,
+                    double h0, size_t max, size_t *id, double *h);
 
 /* refraction */
 double ref_refraction_true_to_apparent (double h, int corrected);
 double ref_refraction_apparent_to_true (double h0, int corrected);
+#define REF_STD_PRESSURE 1010.0  /* pressure of Meeus 16.3 and 16.4, millibars */
+#define REF_STD_TEMPERATURE 10.0        /* temperature of Meeus 16.3 and 16.4, Celsius */
+#define REF_TABLE_MIN (-2.0)    /* lowest altitude of the tables, degrees */
+#define REF_TABLE_STEP 0.05     /* altitude step of the tables, degrees */
+#define REF_TABLE_N 1844        /* nodes from REF_TABLE_MIN - step to 90 + 2 steps */
+struct ref_table_s
+{
+    double R[REF_TABLE_N];      /* refraction at the true altitudes REF_TABLE_MIN + (i - 1) * REF_TABLE_STEP, minutes */
+    double R0[REF_TABLE_N];     /* refraction at the same apparent altitudes, minutes */
+};
+double ref_refraction_true_to_apparent_pt (double h, double P, double T);
+double ref_refraction_apparent_to_true_pt (double h0, double P, double T);
+void ref_refraction_true_to_apparent_batch (const double *h, const double *P,
+                                            const double *T, size_t n,
+                                            double *R);
+void ref_refraction_apparent_to_true_batch (const double *h0,
+                                            const double *P, const double *T,
+                                            size_t n, double *R);
+void ref_table_init (double P, double T, struct ref_table_s *table);
+double ref_table_true_to_apparent (const struct ref_table_s *table, double h);
+double ref_table_apparent_to_true (const struct ref_table_s *table,
+                                   double h0);
 
 /* ecliptic */
+void ecl_nutation (double jde, m_acc_t accuracy, double *dpsi,
+                   double *deps);
 double ecl_nut_in_lon (double jde, m_acc_t accuracy);
 double ecl_nut_in_obl (double jde, m_acc_t accuracy);
 m_err_t ecl_mean_obl_ecliptic (double jde, double *obl, m_acc_t accuracy);
@@ -125,18 +392,167 @@ struct eqx_s
 void eqx_get_sol_eqx (struct eqx_s *eqx, m_acc_t accuracy);
 
 /* sun */
+struct sun_apparent_s
+{
+    double lambda;              /* apparent longitude, degrees */
+    double beta;                /* latitude, degrees */
+    double R;                   /* radius vector, AU */
+    double alpha;               /* apparent right ascension, degrees */
+    double delta;               /* apparent declination, degrees */
+    double dpsi;                /* nutation in longitude, arcseconds */
+    double deps;                /* nutation in obliquity, arcseconds */
+    double epsilon;             /* true obliquity of the ecliptic, degrees */
+};
+m_err_t sun_apparent_coord (double jde, m_acc_t accuracy,
+                            struct sun_apparent_s *s);
+m_err_t sun_apparent_coord_batch (const double *jde, size_t n,
+                                  m_acc_t accuracy, struct sun_apparent_s *s);
 m_err_t sun_mean_equatorial_coord (double jde, double *alpha, double *delta,
                                    m_acc_t accuracy);
 m_err_t sun_apparent_equatorial_coord (double jde, double *alpha,
                                        double *delta, m_acc_t accuracy);
+void sun_geometric_coord (double jde, double *O, double *R);
 void sun_mean_ecliptic_coord (double jde, double *lambda, double *beta,
                               double *R);
 void sun_apparent_ecliptic_coord (double jde, double *lambda, double *beta,
                                   double *R);
 
+/* solar rasters */
+struct ras_grid_s
+{
+    double lat0;                /* latitude of the first row */
+    double dlat;                /* latitude step between rows */
+    size_t nlat;                /* number of rows */
+    double lon0;                /* longitude of the first column, negative towards east */
+    double dlon;                /* longitude step between columns */
+    size_t nlon;                /* number of columns */
+};
+m_err_t ras_sun_hor (const struct ras_grid_s *grid, double jd,
+                     m_acc_t accuracy, int nthreads, double *A, double *h);
+
+/* irradiance on panels */
+struct irr_sun_s
+{
+    double s[3];                /* unit vector towards the apparent Sun (south, west, zenith) */
+    double h;                   /* apparent altitude, degrees */
+    double air_mass;            /* relative optical air mass, NAN below the horizon */
+    double E0;                  /* extraterrestrial normal irradiance, W/m2 */
+};
+void irr_panel_normal (double tilt, double A, double *n);
+m_err_t irr_sun (double jd, double step, size_t n, double L, double phi,
+                 double height, m_acc_t accuracy, int nthreads,
+                 struct irr_sun_s *sun);
+m_err_t irr_incidence (const struct irr_sun_s *sun, size_t nt,
+                       const double *n, size_t np, int nthreads,
+                       double *cos_inc, double *poa);
+
+/* terrain horizons */
+struct hzn_dem_s
+{
+    size_t ncols;               /* number of columns */
+    size_t nrows;               /* number of rows */
+    double xll;                 /* longitude of the west edge, positive towards east */
+    double yll;                 /* latitude of the south edge */
+    double cell;                /* size of a cell, degrees */
+    double nodata;              /* value of cells without data in the file */
+    double zmax;                /* highest elevation, meters */
+    float *z;                   /* elevations in meters, row by row from north, NAN without data */
+};
+m_err_t hzn_dem_read (FILE *in, struct hzn_dem_s *dem);
+void hzn_dem_free (struct hzn_dem_s *dem);
+double hzn_dem_elevation (const struct hzn_dem_s *dem, double lon,
+                          double lat);
+m_err_t hzn_profiles (const struct hzn_dem_s *dem, const double *L,
+                      const double *phi, const double *height,
+                      size_t n_sites, size_t n_bins, double max_dist,
+                      int nthreads, float *profile);
+int hzn_is_shaded (const float *profile, size_t n_bins, double A, double h);
+m_err_t hzn_sun_masks (const float *profile, size_t n_bins, const double *L,
+                       const double *phi, size_t n_sites, double jd,
+                       double step, size_t nt, m_acc_t accuracy,
+                       int nthreads, unsigned char *mask);
+
+/* rising, transit and setting */
+#define RST_SUN_ALT (-0.8333)   /* sunrise and sunset */
+#define RST_CIVIL_ALT (-6.0)    /* civil twilight */
+#define RST_NAUTICAL_ALT (-12.0)        /* nautical twilight */
+#define RST_ASTRONOMICAL_ALT (-18.0)    /* astronomical twilight */
+struct rst_ephem_s
+{
+    double jd;                  /* 0h UT of day D */
+    double theta0;              /* apparent sidereal time at Greenwich at jd, degrees */
+    double dt;                  /* Delta T, in days */
+    double alpha[4];            /* Sun at 0h TD of days D-1, D, D+1 and D+2, not reduced to 0-360 */
+    double delta[4];
+    double sd[4];               /* sine of delta */
+    double cd[4];               /* cosine of delta */
+    m_acc_t accuracy;
+};
+typedef enum rst_state_e
+{
+    RST_EVENTS = 0,             /* the altitude is crossed during the day */
+    RST_ALWAYS_ABOVE,           /* e.g. polar day */
+    RST_ALWAYS_BELOW            /* e.g. polar night */
+} rst_state_t;
+struct rst_event_s
+{
+    rst_state_t state;
+    int n_rise;                 /* number of risings during the day, 0 to 2 */
+    int n_set;                  /* number of settings during the day, 0 to 2 */
+    double rise[2];             /* (UT) julian days, sorted */
+    double set[2];
+};
+m_err_t rst_sun_ephem_init (double jd, m_acc_t accuracy,
+                            struct rst_ephem_s *e);
+m_err_t rst_sun_ephem_next (struct rst_ephem_s *e);
+int rst_get_transit (const struct rst_ephem_s *e, double L, double *transit);
+void rst_get_events (const struct rst_ephem_s *e, double L, double phi,
+                     const double *h0, size_t nh, struct rst_event_s *ev);
+
+/* almanacs */
+typedef enum alm_format_e
+{
+    ALM_CSV = 0,
+    ALM_BIN
+} alm_format_t;
+struct alm_rec_s
+{
+    float rise;                 /* hours since 0h UT, NAN if none */
+    float set;                  /* hours since 0h UT, NAN if none */
+    float length;               /* hours above the altitude during the day */
+};
+m_err_t alm_generate (double jd, int n_days, const double *L,
+                      const double *phi, const char *const *names,
+                      size_t n_sites, double h0, m_acc_t accuracy,
+                      int nthreads, alm_format_t format, FILE *out);
 
 /* equation of time */
 m_err_t eqt_equation_of_time (double jde, double *eqt);
+m_err_t eqt_eot_declination (double jde, m_acc_t accuracy, double *eqt,
+                             double *delta);
+m_err_t eqt_table (double jde0, double step, size_t n, m_acc_t accuracy,
+                   int nthreads, double *eqt, double *delta);
+
+/* sundials */
+struct sdl_dial_s
+{
+    double a;                   /* length of the stylus */
+    double sp, cp;              /* sine and cosine of the latitude */
+    double sD, cD;              /* sine and cosine of the gnomonic declination */
+    double sz, cz;              /* sine and cosine of the zenithal distance */
+    double P;                   /* sine of the angle of the polar stylus with the plane */
+    double xc, yc;              /* center of the dial, undefined if P = 0 */
+};
+void sdl_init (double phi, double D, double z, double a,
+               struct sdl_dial_s *dial);
+int sdl_shadow (const struct sdl_dial_s *dial, double H, double delta,
+                double *x, double *y);
+m_err_t sdl_lines (const struct sdl_dial_s *dial, const double *H, size_t nh,
+                   const double *delta, size_t nd, double *x, double *y);
+m_err_t sdl_analemma (const struct sdl_dial_s *dial, double L, double zone,
+                      double jd, double day_step, size_t n_days, double t0,
+                      double t_step, size_t n_times, m_acc_t accuracy,
+                      int nthreads, double *x, double *y);
 
 /* Kepler's equation */
 double kep_get_eccentric_anomaly (double M, double e);
@@ -144,6 +560,8 @@ double kep_get_eccentric_anomaly (double M, double e);
 /* vsop87 */
 void vso_vsop87d_coordinates (double jde, enum planet_e planet,
                               double *coord);
+void vso_vsop87d_earth_coordinates (double jde, m_acc_t accuracy,
+                                    double *coord);
 void vso_vsop87d_dyn_coordinates (double jde, enum planet_e planet,
                                   double *coord);
 
@@ -0,0 +1,256 @@
+/**
+ * @file almanac.c
+ * Daily rising, setting and day length tables of the Sun for many sites.
+ *
+ * The Sun ephemeris of each day (rst_sun_ephem_init (), one Sun position a
+ * day) is computed once for all sites. Days are then processed by blocks:
+ * the sites of a block are shared between threads, and the block is written
+ * to the output before the next one is computed.
+ *
+ * The binary format is a header (struct alm_header_s) followed by n_days x
+ * n_sites records (struct alm_rec_s), day by day, sites in the order of
+ * the input arrays.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include "meeus.h"
+
+#define ALM_MAGIC "MEEUSALM"
+#define ALM_VERSION 1
+/* number of days computed before being written */
+#define ALM_DAYS 32
+/* number of sites per chunk of the parallel loop */
+#define ALM_GRAIN 64
+
+/**
+ * @brief header of a binary almanac
+ */
+struct alm_header_s
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t n_sites;
+    uint32_t n_days;
+    uint32_t reserved;
+    double jd;                  /* 0h UT of the first day */
+    double h0;                  /* altitude of the events, degrees */
+};
+
+/**
+ * @brief context of the site kernel
+ */
+struct alm_ctx_s
+{
+    const struct rst_ephem_s *eph;      /* ephemeris of the first day of the block */
+    int n_days;                 /* number of days of the block */
+    const double *L;
+    const double *phi;
+    size_t n_sites;
+    double h0;
+    struct alm_rec_s *rec;      /* records of the block, day by day */
+};
+
+/**
+ * @brief time spent above the altitude during the day
+ *
+ * @param[in] ev events of the day
+ * @param[in] jd 0h UT of the day
+ *
+ * @return time in hours
+ */
+static float
+alm_length (const struct rst_event_s *ev, double jd)
+{
+    int i = 0, j = 0, up;
+    double t0 = 0, length = 0;
+
+    if (ev->state != RST_EVENTS)
+        return ev->state == RST_ALWAYS_ABOVE ? 24 : 0;
+
+    /* above at 0h UT if the first event is a setting */
+    up = ev->n_set && (!ev->n_rise || ev->set[0] < ev->rise[0]);
+    while (i < ev->n_rise || j < ev->n_set) {
+        int is_rise = j == ev->n_set || (i < ev->n_rise
+                                         && ev->rise[i] < ev->set[j]);
+        double t = (is_rise ? ev->rise[i++] : ev->set[j++]) - jd;
+        if (up)
+            length += t - t0;
+        up = is_rise;
+        t0 = t;
+    }
+    if (up)
+        length += 1 - t0;
+    return length * 24;
+}
+
+/**
+ * @brief fill the records of the sites [begin, end) for the days of the block
+ *
+ * @param[in] begin first site
+ * @param[in] end last site + 1
+ * @param[in] arg context
+ */
+static void
+alm_sites (size_t begin, size_t end, void *arg)
+{
+    const struct alm_ctx_s *ctx = arg;
+    struct rst_event_s ev;
+
+    for (int d = 0; d < ctx->n_days; d++) {
+        const struct rst_ephem_s *e = &ctx->eph[d];
+        for (size_t i = begin; i < end; i++) {
+            struct alm_rec_s *r = &ctx->rec[d * ctx->n_sites + i];
+            rst_get_events (e, ctx->L[i], ctx->phi[i], &ctx->h0, 1, &ev);
+            r->rise = ev.n_rise ? (ev.rise[0] - e->jd) * 24 : NAN;
+            r->set = ev.n_set ? (ev.set[0] - e->jd) * 24 : NAN;
+            r->length = alm_length (&ev, e->jd);
+        }
+    }
+}
+
+/**
+ * @brief format hours as HH:MM, or nothing for NAN
+ *
+ * @param[in] hours time in hours
+ * @param[out] s output, at least 6 characters
+ *
+ * @return number of characters written
+ */
+static int
+alm_hhmm (float hours, char *s)
+{
+    if (isnan (hours))
+        return 0;
+    int m = (int) lround (hours * 60);
+    s[0] = '0' + m / 600;
+    s[1] = '0' + m / 60 % 10;
+    s[2] = ':';
+    s[3] = '0' + m % 60 / 10;
+    s[4] = '0' + m % 10;
+    return 5;
+}
+
+/**
+ * @brief write the records of a block as CSV lines
+ *
+ * @param[in] ctx block
+ * @param[in] names names of the sites. Can be NULL.
+ * @param[in] out output file
+ *
+ * @return error status
+ */
+static m_err_t
+alm_write_csv (const struct alm_ctx_s *ctx, const char *const *names,
+               FILE *out)
+{
+    char date[16], line[64];
+    struct tm tm;
+
+    for (int d = 0; d < ctx->n_days; d++) {
+        dt_jd_to_date (ctx->eph[d].jd, &tm);
+        strftime (date, sizeof date, "%Y-%m-%d", &tm);
+        for (size_t i = 0; i < ctx->n_sites; i++) {
+            const struct alm_rec_s *r = &ctx->rec[d * ctx->n_sites + i];
+            char *p = line;
+            *p++ = ',';
+            p += alm_hhmm (r->rise, p);
+            *p++ = ',';
+            p += alm_hhmm (r->set, p);
+            *p++ = ',';
+            p += alm_hhmm (r->length, p);
+            *p++ = '\n';
+            *p = 0;
+            if (names)
+                fprintf (out, "%s,\"%s\"%s", date, names[i], line);
+            else
+                fprintf (out, "%s,%zu%s", date, i, line);
+        }
+    }
+    return ferror (out) ? M_IO_ERR : M_NO_ERR;
+}
+
+/**
+ * @brief Generate a table of rising, setting and day length of the Sun
+ *
+ * For each day and site: first rising and first setting of the Sun during
+ * the (UT) day, and the time the Sun spends above h0 during the day.
+ * The CSV format has one line per day and site, sites of a same day being
+ * contiguous:
+ * date,site,rise,set,length with times as HH:MM (UT) and empty fields when
+ * there is no event.
+ *
+ * @param[in] jd any (UT) julian day of the first day
+ * @param[in] n_days number of days
+ * @param[in] L sites longitudes, negative towards east
+ * @param[in] phi sites latitudes
+ * @param[in] names sites names, for the CSV format. Can be NULL to use the site index.
+ * @param[in] n_sites number of sites
+ * @param[in] h0 altitude of the events, in degrees (e.g. RST_SUN_ALT)
+ * @param[in] accuracy accuracy of the Sun coordinates
+ * @param[in] nthreads number of threads. 0 to use all processors.
+ * @param[in] format ALM_CSV or ALM_BIN
+ * @param[in] out output file
+ *
+ * @return error status of the function
+ * @retval M_INVALID_RANGE_ERR no day, no site or jd is out of range
+ * @retval M_NO_MEM_ERR memory allocation failure
+ * @retval M_IO_ERR write error
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+alm_generate (double jd, int n_days, const double *L, const double *phi,
+              const char *const *names, size_t n_sites, double h0,
+              m_acc_t accuracy, int nthreads, alm_format_t format, FILE *out)
+{
+    struct rst_ephem_s *eph;
+    struct alm_rec_s *rec;
+    m_err_t err;
+
+    if (n_days <= 0 || n_sites == 0)
+        return M_INVALID_RANGE_ERR;
+    eph = malloc (n_days * sizeof *eph);
+    rec = malloc (ALM_DAYS * n_sites * sizeof *rec);
+    if (!eph || !rec) {
+        free (eph);
+        free (rec);
+        return M_NO_MEM_ERR;
+    }
+
+    /* one Sun position per day, for all sites */
+    err = rst_sun_ephem_init (jd, accuracy, &eph[0]);
+    for (int d = 1; d < n_days && !err; d++) {
+        eph[d] = eph[d - 1];
+        err = rst_sun_ephem_next (&eph[d]);
+    }
+
+    if (!err && format == ALM_BIN) {
+        struct alm_header_s hdr = {.magic = ALM_MAGIC,.version = ALM_VERSION,
+            .n_sites = (uint32_t) n_sites,.n_days = (uint32_t) n_days,
+            .jd = eph[0].jd,.h0 = h0
+        };
+        if (fwrite (&hdr, sizeof hdr, 1, out) != 1)
+            err = M_IO_ERR;
+    } else if (!err && fputs ("date,site,rise,set,length\n", out) == EOF)
+        err = M_IO_ERR;
+
+    for (int d0 = 0; d0 < n_days && !err; d0 += ALM_DAYS) {
+        struct alm_ctx_s ctx = { eph + d0,
+            n_days - d0 < ALM_DAYS ? n_days - d0 : ALM_DAYS,
+            L, phi, n_sites, h0, rec
+        };
+        thr_for (n_sites, ALM_GRAIN, nthreads, alm_sites, &ctx);
+        if (format == ALM_BIN) {
+            size_t n = ctx.n_days * n_sites;
+            if (fwrite (rec, sizeof *rec, n, out) != n)
+                err = M_IO_ERR;
+        } else
+            err = alm_write_csv (&ctx, names, out);
+    }
+    free (eph);
+    free (rec);
+    return err;
+}
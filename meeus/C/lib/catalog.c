@@ -0,0 +1,436 @@
+/**
+ * @file catalog.c
+ * Star catalogs and apparent places.
+ *
+ * A text catalog is compiled once into a binary file holding the stars as
+ * a structure of arrays: unit vectors and proper motion vectors in the
+ * mean equator and equinox of J2000.0. The binary file is memory mapped,
+ * so that opening a catalog costs no parsing nor copy.
+ *
+ * Apparent places (Meeus chapter 23) are computed for the whole catalog.
+ * Everything that depends on the date only (precession, nutation, Earth
+ * velocity for the annual aberration) is computed once in a struct
+ * cat_epoch_s, so that each star costs a few vector operations.
+ *
+ * Text format: one star per line, fields separated by spaces or tabs:
+ *
+ *     id ra dec pmra pmdec mag
+ *
+ * - id: integer identifier (e.g. HR or HIP number)
+ * - ra, dec: J2000.0 right ascension and declination, in degrees
+ * - pmra: proper motion in right ascension, multiplied by cos (dec), in milliarcseconds per year
+ * - pmdec: proper motion in declination, in milliarcseconds per year
+ * - mag: visual magnitude
+ *
+ * Empty lines and lines starting with # are ignored.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "meeus.h"
+
+#define CAT_MAGIC "MEEUSCAT"
+#define CAT_VERSION 1
+#define CAT_MAX_LINE 512
+/* suffix of the file written by cat_compile () before it is renamed */
+#define CAT_TMP_SUFFIX ".tmp"
+/* number of arrays of a compiled catalog: id, x, y, z, vx, vy, vz, mag */
+#define CAT_NARRAYS 8
+/* number of stars processed at once */
+#define CAT_BLOCK 256
+/* number of stars per chunk of the parallel loop */
+#define CAT_GRAIN 8192
+/* milliarcseconds to radians */
+#define CAT_MAS_TO_RAD (M_PI / (180.0 * 3600.0 * 1000.0))
+/* constant of aberration, in radians (Meeus chapter 23) */
+#define CAT_KAPPA (20.49552 / 3600.0 * M_PI / 180.0)
+
+/**
+ * @brief header of a compiled catalog. Followed by CAT_NARRAYS arrays of count 8-byte values.
+ */
+struct cat_header_s
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+    double epoch;
+};
+
+/**
+ * @brief one parsed star
+ */
+struct cat_record_s
+{
+    int64_t id;
+    double v[6];
+    double mag;
+};
+
+/**
+ * @brief parse one line of a text catalog
+ *
+ * @param[in] line the text line
+ * @param[out] rec the parsed star
+ *
+ * @return 1 if the line holds a star, 0 otherwise
+ */
+static int
+cat_parse (const char *line, struct cat_record_s *rec)
+{
+    long long id;
+    double ra, dec, pmra, pmdec, mag;
+    double sa, ca, sd, cd;
+
+    if (line[0] == '#'
+        || sscanf (line, "%lld %lf %lf %lf %lf %lf", &id, &ra, &dec, &pmra,
+                   &pmdec, &mag) != 6 || fabs (dec) > 90)
+        return 0;
+
+    m_sincosd (ra, &sa, &ca);
+    m_sincosd (dec, &sd, &cd);
+    pmra *= CAT_MAS_TO_RAD;
+    pmdec *= CAT_MAS_TO_RAD;
+    rec->id = id;
+    rec->v[0] = cd * ca;
+    rec->v[1] = cd * sa;
+    rec->v[2] = sd;
+    /* pmra along (-sin ra, cos ra, 0), pmdec along the meridian, northward */
+    rec->v[3] = -pmra * sa - pmdec * sd * ca;
+    rec->v[4] = pmra * ca - pmdec * sd * sa;
+    rec->v[5] = pmdec * cd;
+    rec->mag = mag;
+    return 1;
+}
+
+/**
+ * @brief Compile a text catalog into a binary catalog
+ *
+ * The catalog is written to bin_path.tmp and renamed to bin_path, so that
+ * a catalog opened from bin_path stays valid and a failed compilation
+ * leaves bin_path untouched.
+ *
+ * @param[in] txt_path path of the text catalog
+ * @param[in] bin_path path of the binary catalog to create
+ *
+ * @return error status of the function
+ * @retval M_IO_ERR a file could not be read or written
+ * @retval M_FORMAT_ERR the input holds no star
+ * @retval M_NO_MEM_ERR memory allocation failed
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+cat_compile (const char *txt_path, const char *bin_path)
+{
+    char line[CAT_MAX_LINE];
+    struct cat_record_s *recs = NULL, rec;
+    size_t n = 0, cap = 0;
+    m_err_t err = M_NO_ERR;
+    FILE *in, *out;
+
+    in = fopen (txt_path, "r");
+    if (!in)
+        return M_IO_ERR;
+
+    while (fgets (line, sizeof line, in)) {
+        if (!cat_parse (line, &rec))
+            continue;
+        if (n == cap) {
+            struct cat_record_s *tmp;
+            cap = cap ? 2 * cap : 4096;
+            tmp = realloc (recs, cap * sizeof *recs);
+            if (!tmp) {
+                err = M_NO_MEM_ERR;
+                break;
+            }
+            recs = tmp;
+        }
+        recs[n++] = rec;
+    }
+    fclose (in);
+    if (!err && (n == 0 || n > UINT32_MAX))
+        err = M_FORMAT_ERR;
+    if (err) {
+        free (recs);
+        return err;
+    }
+
+    struct cat_header_s hdr = {.magic = CAT_MAGIC,.version = CAT_VERSION,
+        .count = (uint32_t) n,.epoch = MT_JD_EPOCH
+    };
+    /* a catalog still mapped from bin_path must not change under its
+       readers: write a new file and rename it over the old one */
+    size_t len = strlen (bin_path);
+    char *tmp_path = malloc (len + sizeof CAT_TMP_SUFFIX);
+    if (!tmp_path) {
+        free (recs);
+        return M_NO_MEM_ERR;
+    }
+    memcpy (tmp_path, bin_path, len);
+    memcpy (tmp_path + len, CAT_TMP_SUFFIX, sizeof CAT_TMP_SUFFIX);
+    out = fopen (tmp_path, "wb");
+    if (!out) {
+        free (tmp_path);
+        free (recs);
+        return M_IO_ERR;
+    }
+    if (fwrite (&hdr, sizeof hdr, 1, out) != 1)
+        err = M_IO_ERR;
+    for (size_t i = 0; !err && i < n; i++)
+        if (fwrite (&recs[i].id, sizeof recs[i].id, 1, out) != 1)
+            err = M_IO_ERR;
+    for (int k = 0; k < 6; k++)
+        for (size_t i = 0; !err && i < n; i++)
+            if (fwrite (&recs[i].v[k], sizeof (double), 1, out) != 1)
+                err = M_IO_ERR;
+    for (size_t i = 0; !err && i < n; i++)
+        if (fwrite (&recs[i].mag, sizeof recs[i].mag, 1, out) != 1)
+            err = M_IO_ERR;
+    if (!err && (fflush (out) || fsync (fileno (out))))
+        err = M_IO_ERR;
+    if (fclose (out) && !err)
+        err = M_IO_ERR;
+    if (!err && rename (tmp_path, bin_path))
+        err = M_IO_ERR;
+    if (err)
+        unlink (tmp_path);
+    free (tmp_path);
+    free (recs);
+    return err;
+}
+
+/**
+ * @brief Map a compiled catalog
+ *
+ * @param[in] bin_path path of a catalog created by cat_compile()
+ * @param[out] cat the catalog. Release it with cat_close().
+ *
+ * @return error status of the function
+ * @retval M_IO_ERR the file could not be opened or mapped
+ * @retval M_FORMAT_ERR the file is not a valid compiled catalog
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+cat_open (const char *bin_path, struct cat_s *cat)
+{
+    struct stat st;
+    const struct cat_header_s *hdr;
+    void *map;
+    int fd;
+
+    fd = open (bin_path, O_RDONLY);
+    if (fd < 0)
+        return M_IO_ERR;
+    if (fstat (fd, &st) || st.st_size < sizeof *hdr) {
+        close (fd);
+        return M_IO_ERR;
+    }
+    map = mmap (NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close (fd);
+    if (map == MAP_FAILED)
+        return M_IO_ERR;
+
+    hdr = map;
+    if (memcmp (hdr->magic, CAT_MAGIC, sizeof hdr->magic)
+        || hdr->version != CAT_VERSION || hdr->count == 0
+        || st.st_size !=
+        sizeof *hdr + (size_t) hdr->count * CAT_NARRAYS * sizeof (double)) {
+        munmap (map, st.st_size);
+        return M_FORMAT_ERR;
+    }
+
+    const double *a = (const double *) (hdr + 1);
+    size_t n = hdr->count;
+    cat->map = map;
+    cat->map_len = st.st_size;
+    cat->count = n;
+    cat->epoch = hdr->epoch;
+    cat->id = (const int64_t *) a;
+    cat->x = a + n;
+    cat->y = a + 2 * n;
+    cat->z = a + 3 * n;
+    cat->vx = a + 4 * n;
+    cat->vy = a + 5 * n;
+    cat->vz = a + 6 * n;
+    cat->mag = a + 7 * n;
+    return M_NO_ERR;
+}
+
+/**
+ * @brief Unmap a catalog
+ *
+ * @param[in,out] cat catalog opened by cat_open()
+ */
+void
+cat_close (struct cat_s *cat)
+{
+    if (cat->map)
+        munmap (cat->map, cat->map_len);
+    cat->map = NULL;
+    cat->count = 0;
+}
+
+/**
+ * @brief Compute the date dependent terms of the apparent places
+ *
+ * - precession from J2000.0 (Meeus 21.3) and nutation (Meeus chapter 22), as one rotation
+ * - Earth velocity divided by the speed of light, for the annual aberration,
+ *   from the vector form of Meeus 23.2: kappa (sin O - e sin pi, -cos O + e cos pi, 0)
+ *   in the ecliptic of date, with O the Sun true longitude.
+ *
+ * @param[in] jde Julian Day Ephemeris (Dynamical time)
+ * @param[out] ep date dependent terms
+ *
+ * @return error status of the function
+ * @retval M_INVALID_RANGE_ERR jde is out of the validity range of the obliquity
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+cat_get_epoch (double jde, struct cat_epoch_s *ep)
+{
+    struct rot_mat_s prec, ecl;
+    double O, R, epsilon, sO, cO, sp, cp;
+    double T = get_century_since_j2000 (jde);
+    m_err_t err;
+
+    ep->t = (jde - MT_JD_EPOCH) / 365.25;
+    rot_precession (jde, &prec);
+    err = rot_nutation (jde, M_HIGH_ACC, &ep->m);
+    if (err)
+        return err;
+    rot_mul (&ep->m, &prec, &ep->m);
+
+    err = ecl_true_obl_ecliptic (jde, &epsilon, M_HIGH_ACC);
+    if (err)
+        return err;
+    sun_geometric_coord (jde, &O, &R);
+    double e = polynom ((const double[]) { 0.016708634, -0.000042037,
+                        -0.0000001267
+                        }, T, 2);
+    double pi = polynom ((const double[]) { 102.93735, 1.71946, 0.00046 }, T,
+                         2);
+    m_sincosd (O, &sO, &cO);
+    m_sincosd (pi, &sp, &cp);
+    double v[3] = { CAT_KAPPA * (sO - e * sp), CAT_KAPPA * (-cO + e * cp), 0 };
+    rot_ecl_to_equ (arcsec_to_deg (epsilon), &ecl);
+    for (int i = 0; i < 3; i++)
+        ep->v[i] = ecl.m[i][0] * v[0] + ecl.m[i][1] * v[1];
+    return M_NO_ERR;
+}
+
+/**
+ * @brief context of the apparent place kernel
+ */
+struct cat_ctx_s
+{
+    const struct cat_s *cat;
+    const struct cat_epoch_s *ep;
+    double *x, *y, *z;
+    double *alpha, *delta;
+};
+
+/**
+ * @brief apparent places of the stars [begin, end)
+ *
+ * @param[in] begin first star
+ * @param[in] end last star + 1
+ * @param[in] arg context
+ */
+static void
+cat_apparent_chunk (size_t begin, size_t end, void *arg)
+{
+    const struct cat_ctx_s *ctx = arg;
+    const struct cat_s *cat = ctx->cat;
+    const double (*m)[3] = ctx->ep->m.m;
+    const double t = ctx->ep->t;
+    const double *v = ctx->ep->v;
+    double x[CAT_BLOCK], y[CAT_BLOCK], z[CAT_BLOCK], rho[CAT_BLOCK];
+
+    for (size_t i0 = begin; i0 < end; i0 += CAT_BLOCK) {
+        size_t n = end - i0 < CAT_BLOCK ? end - i0 : CAT_BLOCK;
+        const double *cx = cat->x + i0, *cy = cat->y + i0, *cz = cat->z + i0;
+        const double *vx = cat->vx + i0, *vy = cat->vy + i0,
+            *vz = cat->vz + i0;
+        for (size_t i = 0; i < n; i++) {
+            /* proper motion, precession and nutation, then aberration */
+            double px = cx[i] + t * vx[i];
+            double py = cy[i] + t * vy[i];
+            double pz = cz[i] + t * vz[i];
+            double qx = m[0][0] * px + m[0][1] * py + m[0][2] * pz;
+            double qy = m[1][0] * px + m[1][1] * py + m[1][2] * pz;
+            double qz = m[2][0] * px + m[2][1] * py + m[2][2] * pz;
+            double k = 1 / sqrt (qx * qx + qy * qy + qz * qz);
+            qx = qx * k + v[0];
+            qy = qy * k + v[1];
+            qz = qz * k + v[2];
+            k = 1 / sqrt (qx * qx + qy * qy + qz * qz);
+            x[i] = qx * k;
+            y[i] = qy * k;
+            z[i] = qz * k;
+        }
+        if (ctx->x) {
+            memcpy (ctx->x + i0, x, n * sizeof *x);
+            memcpy (ctx->y + i0, y, n * sizeof *y);
+            memcpy (ctx->z + i0, z, n * sizeof *z);
+        }
+        if (ctx->alpha) {
+            m_atan2d_batch (y, x, n, ctx->alpha + i0);
+            for (size_t i = 0; i < n; i++)
+                ctx->alpha[i0 + i] += ctx->alpha[i0 + i] < 0 ? 360 : 0;
+        }
+        if (ctx->delta) {
+            for (size_t i = 0; i < n; i++)
+                rho[i] = sqrt (x[i] * x[i] + y[i] * y[i]);
+            m_atan2d_batch (z, rho, n, ctx->delta + i0);
+        }
+    }
+}
+
+/**
+ * @brief Compute the apparent directions of all the stars of a catalog
+ *
+ * Unit vectors in the true equator and equinox of date.
+ *
+ * @param[in] cat catalog
+ * @param[in] ep date dependent terms, from cat_get_epoch()
+ * @param[in] nthreads number of threads. 0 to use all processors.
+ * @param[out] x x components (towards the true equinox of date)
+ * @param[out] y y components
+ * @param[out] z z components (towards the true celestial north pole)
+ */
+void
+cat_apparent_vec (const struct cat_s *cat, const struct cat_epoch_s *ep,
+                  int nthreads, double *x, double *y, double *z)
+{
+    struct cat_ctx_s ctx = { cat, ep, x, y, z, NULL, NULL };
+
+    thr_for (cat->count, CAT_GRAIN, nthreads, cat_apparent_chunk, &ctx);
+}
+
+/**
+ * @brief Compute the apparent places of all the stars of a catalog
+ *
+ * Implements Meeus chapters 21 to 23: proper motion, precession, nutation
+ * and annual aberration. Proper motion is linear on the unit sphere, radial
+ * velocities are ignored.
+ *
+ * @param[in] cat catalog
+ * @param[in] ep date dependent terms, from cat_get_epoch()
+ * @param[in] nthreads number of threads. 0 to use all processors.
+ * @param[out] alpha apparent right ascensions, in degrees between 0 and 360. Can be NULL.
+ * @param[out] delta apparent declinations, in degrees. Can be NULL.
+ */
+void
+cat_apparent_place (const struct cat_s *cat, const struct cat_epoch_s *ep,
+                    int nthreads, double *alpha, double *delta)
+{
+    struct cat_ctx_s ctx = { cat, ep, NULL, NULL, NULL, alpha, delta };
+
+    thr_for (cat->count, CAT_GRAIN, nthreads, cat_apparent_chunk, &ctx);
+}
@@ -3,6 +3,7 @@
  * Meeus chapter 13. Transformation of coordinate.
  */
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 #include <time.h>
 #include "meeus.h"
@@ -40,14 +41,13 @@ void
 coo_equ_to_ecl (double alpha, double delta, double epsilon, double *lambda,
                 double *beta)
 {
-    *lambda =
-        rad_to_deg (atan2
-                    (sind (alpha) * cosd (epsilon) +
-                     tand (delta) * sind (epsilon), cosd (alpha)));
-    *beta =
-        rad_to_deg (asin
-                    (sind (delta) * cosd (epsilon) -
-                     cosd (delta) * sind (epsilon) * sind (alpha)));
+    double sa, ca, sd, cd, se, ce;
+
+    m_sincosd (alpha, &sa, &ca);
+    m_sincosd (delta, &sd, &cd);
+    m_sincosd (epsilon, &se, &ce);
+    *lambda = m_atan2d (sa * ce + m_tand (delta) * se, ca);
+    *beta = m_asind (sd * ce - cd * se * sa);
 }
 
 /**
@@ -69,14 +69,13 @@ void
 coo_ecl_to_equ (double lambda, double beta, double epsilon, double *alpha,
                 double *delta)
 {
-    *alpha =
-        rad_to_deg (atan2
-                    (sind (lambda) * cosd (epsilon) -
-                     tand (beta) * sind (epsilon), cosd (lambda)));
-    *delta =
-        rad_to_deg (asin
-                    (sind (beta) * cosd (epsilon) +
-                     cosd (beta) * sind (epsilon) * sind (lambda)));
+    double sl, cl, sb, cb, se, ce;
+
+    m_sincosd (lambda, &sl, &cl);
+    m_sincosd (beta, &sb, &cb);
+    m_sincosd (epsilon, &se, &ce);
+    *alpha = m_atan2d (sl * ce - m_tand (beta) * se, cl);
+    *delta = m_asind (sb * ce + cb * se * sl);
 }
 
 /**
@@ -97,12 +96,13 @@ coo_ecl_to_equ (double lambda, double beta, double epsilon, double *alpha,
 void
 coo_equ_to_hor (double H, double delta, double phi, double *A, double *h)
 {
-    *A = rad_to_deg (atan2
-                     (sind (H),
-                      cosd (H) * sind (phi) - tand (delta) * cosd (phi)));
-    *h = rad_to_deg (asin
-                     (sind (phi) * sind (delta) +
-                      cosd (phi) * cosd (delta) * cosd (H)));
+    double sH, cH, sd, cd, sp, cp;
+
+    m_sincosd (H, &sH, &cH);
+    m_sincosd (delta, &sd, &cd);
+    m_sincosd (phi, &sp, &cp);
+    *A = m_atan2d (sH, cH * sp - m_tand (delta) * cp);
+    *h = m_asind (sp * sd + cp * cd * cH);
 }
 
 /**
@@ -122,12 +122,13 @@ coo_equ_to_hor (double H, double delta, double phi, double *A, double *h)
 void
 coo_hor_to_equ (double A, double h, double phi, double *H, double *delta)
 {
-    *H = rad_to_deg (atan2
-                     (sind (A),
-                      cosd (A) * sind (phi) + tand (h) * cosd (phi)));
-    *delta = rad_to_deg (asin
-                         (sind (phi) * sind (h) -
-                          cosd (phi) * cosd (h) * cosd (A)));
+    double sA, cA, sh, ch, sp, cp;
+
+    m_sincosd (A, &sA, &cA);
+    m_sincosd (h, &sh, &ch);
+    m_sincosd (phi, &sp, &cp);
+    *H = m_atan2d (sA, cA * sp + m_tand (h) * cp);
+    *delta = m_asind (sp * sh - cp * ch * cA);
 }
 
 /**
@@ -167,3 +168,366 @@ coo_get_local_hour_angle (double jd, double L, double alpha,
     }
     return M_NO_ERR;
 }
+
+/**
+ * @brief   Return local hour angle of a body from a timestamp
+ *
+ * @param[in] t timestamp (Universal Time) of the observation
+ * @param[in] L longitude of the observer, negative towards east
+ * @param[in] alpha body right ascension
+ * @param[in] is_apparent set this parameter to 1 if alpha is apparent (e.g. affected by nutation)
+ *
+ * @param[out] hour_angle local hour angle of the body, measured westward from south
+ *
+ * @return return error code
+ * @retval M_NO_ERR The function was successfully executed
+ *
+ * @see coo_get_local_hour_angle ()
+ */
+m_err_t
+coo_get_local_hour_angle_mt (m_time_t t, double L, double alpha,
+                             double *hour_angle, int is_apparent)
+{
+    double sid_t;
+    m_err_t err = is_apparent ? sid_get_apparent_gw_sid_time_mt (t, &sid_t) :
+        sid_get_mean_gw_sid_time_mt (t, &sid_t);
+    if (err)
+        return err;
+    *hour_angle = rerange (s_to_deg (sid_t) - L - alpha, 360);
+    return M_NO_ERR;
+}
+
+/**
+ * @brief   Return local hour angle of a body from sidereal time
+ *
+ * For callers that already have Greenwich sidereal time, e.g. from
+ * sid_stepper_next ().
+ *
+ * @param[in] sid_t sidereal time at Greenwich, in seconds of time
+ * @param[in] L longitude of the observer, negative towards east
+ * @param[in] alpha body right ascension
+ *
+ * @return local hour angle of the body, measured westward from south, between 0 and 360
+ */
+double
+coo_get_local_hour_angle_sid (double sid_t, double L, double alpha)
+{
+    return rerange (s_to_deg (sid_t) - L - alpha, 360);
+}
+
+/* number of bodies processed at once by the batch functions */
+#define COO_BLOCK 256
+
+/**
+ * @brief   Kernel of the ecliptical batch functions
+ *
+ * Computes out1 = atan2 (sin a cos b c - sin b s, cos a cos b) and
+ * out2 = asin (sin b c + cos b s sin a), that is Meeus 13.3 and 13.4
+ * multiplied by cos (b), with c = cos (epsilon) and s = +/- sin (epsilon)
+ * depending on the direction.
+ */
+static void
+coo_rotate_batch (const double *restrict lon, const double *restrict lat,
+                  size_t n, double c, double s, double *restrict lon_out,
+                  double *restrict lat_out)
+{
+    double sl[COO_BLOCK], cl[COO_BLOCK], sb[COO_BLOCK], cb[COO_BLOCK];
+    double y[COO_BLOCK], x[COO_BLOCK], z[COO_BLOCK];
+
+    for (size_t i0 = 0; i0 < n; i0 += COO_BLOCK) {
+        size_t m = n - i0 < COO_BLOCK ? n - i0 : COO_BLOCK;
+        m_sincosd_batch (lon + i0, m, sl, cl);
+        m_sincosd_batch (lat + i0, m, sb, cb);
+        for (size_t i = 0; i < m; i++) {
+            y[i] = sl[i] * cb[i] * c - sb[i] * s;
+            x[i] = cl[i] * cb[i];
+            z[i] = sb[i] * c + cb[i] * s * sl[i];
+        }
+        m_atan2d_batch (y, x, m, lon_out + i0);
+        m_asind_batch (z, m, lat_out + i0);
+    }
+}
+
+/**
+ * @brief   Convert arrays of equatorial to ecliptical coordinates
+ *
+ * Batch version of coo_equ_to_ecl (), for bodies sharing the same obliquity.
+ *
+ * @param[in] alpha bodies right ascensions
+ * @param[in] delta bodies declinations
+ * @param[in] n number of bodies
+ * @param[in] epsilon obliquity of the ecliptic
+ *
+ * @param[out] lambda ecliptical longitudes
+ * @param[out] beta ecliptical latitudes
+ *
+ * All parameters are in degrees. Returned values are in degrees
+ */
+void
+coo_equ_to_ecl_batch (const double *alpha, const double *delta, size_t n,
+                      double epsilon, double *lambda, double *beta)
+{
+    double s, c;
+
+    m_sincosd (epsilon, &s, &c);
+    /* rotation by -epsilon around the equinox direction */
+    coo_rotate_batch (alpha, delta, n, c, -s, lambda, beta);
+}
+
+/**
+ * @brief   Convert arrays of ecliptical to equatorial coordinates
+ *
+ * Batch version of coo_ecl_to_equ (), for bodies sharing the same obliquity.
+ *
+ * @param[in] lambda ecliptical longitudes
+ * @param[in] beta ecliptical latitudes
+ * @param[in] n number of bodies
+ * @param[in] epsilon obliquity of the ecliptic
+ *
+ * @param[out] alpha bodies right ascensions
+ * @param[out] delta bodies declinations
+ *
+ * All parameters are in degrees. Returned values are in degrees
+ */
+void
+coo_ecl_to_equ_batch (const double *lambda, const double *beta, size_t n,
+                      double epsilon, double *alpha, double *delta)
+{
+    double s, c;
+
+    m_sincosd (epsilon, &s, &c);
+    coo_rotate_batch (lambda, beta, n, c, s, alpha, delta);
+}
+
+/**
+ * @brief   Kernel of the horizontal batch functions
+ *
+ * Computes out1 = atan2 (sin a cos b, cos a cos b sin phi - k sin b cos phi)
+ * and out2 = asin (sin phi sin b + k cos phi cos b cos a), which is
+ * Meeus 13.5 and 13.6 (k = 1) and their inverse (k = -1), multiplied by cos (b).
+ */
+static void
+coo_hor_batch (const double *restrict a, const double *restrict b, size_t n,
+               double phi, double k, double *restrict out1,
+               double *restrict out2)
+{
+    double sa[COO_BLOCK], ca[COO_BLOCK], sb[COO_BLOCK], cb[COO_BLOCK];
+    double y[COO_BLOCK], x[COO_BLOCK], z[COO_BLOCK];
+    double sp, cp;
+
+    m_sincosd (phi, &sp, &cp);
+    for (size_t i0 = 0; i0 < n; i0 += COO_BLOCK) {
+        size_t m = n - i0 < COO_BLOCK ? n - i0 : COO_BLOCK;
+        m_sincosd_batch (a + i0, m, sa, ca);
+        m_sincosd_batch (b + i0, m, sb, cb);
+        for (size_t i = 0; i < m; i++) {
+            y[i] = sa[i] * cb[i];
+            x[i] = ca[i] * cb[i] * sp - k * sb[i] * cp;
+            z[i] = sp * sb[i] + k * cp * cb[i] * ca[i];
+        }
+        m_atan2d_batch (y, x, m, out1 + i0);
+        m_asind_batch (z, m, out2 + i0);
+    }
+}
+
+/**
+ * @brief   Convert arrays of equatorial to horizontal coordinates
+ *
+ * Batch version of coo_equ_to_hor (), for bodies seen by the same observer.
+ *
+ * @param[in] H local hour angles of the bodies, measured westward from south
+ * @param[in] delta bodies declinations
+ * @param[in] n number of bodies
+ * @param[in] phi observer latitude
+ *
+ * @param[out] A azimuths
+ * @param[out] h altitudes of the bodies
+ *
+ * All parameters are in degrees. Returned values are in degrees
+ */
+void
+coo_equ_to_hor_batch (const double *H, const double *delta, size_t n,
+                      double phi, double *A, double *h)
+{
+    coo_hor_batch (H, delta, n, phi, 1, A, h);
+}
+
+/**
+ * @brief   Convert arrays of horizontal to equatorial coordinates
+ *
+ * Batch version of coo_hor_to_equ (), for bodies seen by the same observer.
+ *
+ * @param[in] A azimuths
+ * @param[in] h altitudes of the bodies
+ * @param[in] n number of bodies
+ * @param[in] phi observer latitude
+ *
+ * @param[out] H local hour angles of the bodies
+ * @param[out] delta bodies declinations
+ *
+ * All parameters are in degrees. Returned values are in degrees
+ */
+void
+coo_hor_to_equ_batch (const double *A, const double *h, size_t n, double phi,
+                      double *H, double *delta)
+{
+    coo_hor_batch (A, h, n, phi, -1, H, delta);
+}
+
+/**
+ * @brief   Return local hour angles of an array of bodies
+ *
+ * Batch version of coo_get_local_hour_angle (). Sidereal time is computed once.
+ *
+ * @param[in] jd the dynamic (UT) julian day of the observation
+ * @param[in] L longitude of the observer, negative towards east
+ * @param[in] alpha bodies right ascensions
+ * @param[in] n number of bodies
+ * @param[in] is_apparent set this parameter to 1 if alpha is apparent (e.g. affected by nutation)
+ *
+ * @param[out] hour_angle local hour angles of the bodies, measured westward from south
+ *
+ * @return return error code
+ * @retval M_NO_ERR The function was successfully executed
+ *
+ * All angle parameters are in degrees. Returned values are in degrees
+ */
+m_err_t
+coo_get_local_hour_angle_batch (double jd, double L, const double *alpha,
+                                size_t n, double *hour_angle, int is_apparent)
+{
+    double sid_t;
+    m_err_t err = is_apparent ? sid_get_apparent_gw_sid_time (jd, &sid_t) :
+        sid_get_mean_gw_sid_time (jd, &sid_t);
+    if (err)
+        return err;
+
+    double theta = s_to_deg (sid_t) - L;
+    for (size_t i = 0; i < n; i++)
+        hour_angle[i] = rerange (theta - alpha[i], 360);
+    return M_NO_ERR;
+}
+
+/* number of observers per chunk of the observer x object kernel */
+#define COO_OBS_GRAIN 16
+
+/**
+ * @brief   context of the observer x object kernel
+ */
+struct coo_matrix_s
+{
+    const double *L;
+    const double *phi;
+    size_t n_obj;
+    double theta;               /* Greenwich sidereal time in degrees */
+    const double *ca_cd;        /* cos (alpha) cos (delta), per object */
+    const double *sa_cd;        /* sin (alpha) cos (delta), per object */
+    const double *sd;           /* sin (delta), per object */
+    double *A;
+    double *h;
+};
+
+/**
+ * @brief   fill the rows [begin, end) (observers) of the matrices
+ *
+ * With theta the local sidereal time, cos (delta) cos (H) and
+ * cos (delta) sin (H) are expanded from per observer sin/cos (theta) and
+ * per object cos (delta) cos/sin (alpha), so that there is no trigonometry
+ * per pair except the final arc sine and arc tangent.
+ *
+ * @param[in] begin first observer
+ * @param[in] end last observer + 1
+ * @param[in] arg context
+ */
+static void
+coo_matrix_rows (size_t begin, size_t end, void *arg)
+{
+    const struct coo_matrix_s *ctx = arg;
+    const size_t n_obj = ctx->n_obj;
+    double x[COO_BLOCK], y[COO_BLOCK], z[COO_BLOCK];
+
+    /* objects outside, so that a block of objects stays in cache for all the observers */
+    for (size_t j0 = 0; j0 < n_obj; j0 += COO_BLOCK) {
+        size_t m = n_obj - j0 < COO_BLOCK ? n_obj - j0 : COO_BLOCK;
+        const double *ca_cd = ctx->ca_cd + j0, *sa_cd = ctx->sa_cd + j0;
+        const double *sd = ctx->sd + j0;
+        for (size_t i = begin; i < end; i++) {
+            double st, ct, sp, cp;
+            m_sincosd (ctx->theta - ctx->L[i], &st, &ct);
+            m_sincosd (ctx->phi[i], &sp, &cp);
+            for (size_t j = 0; j < m; j++) {
+                double a = ct * ca_cd[j] + st * sa_cd[j];
+                y[j] = st * ca_cd[j] - ct * sa_cd[j];
+                x[j] = sp * a - cp * sd[j];
+                z[j] = cp * a + sp * sd[j];
+            }
+            if (ctx->A)
+                m_atan2d_batch (y, x, m, ctx->A + i * n_obj + j0);
+            if (ctx->h)
+                m_asind_batch (z, m, ctx->h + i * n_obj + j0);
+        }
+    }
+}
+
+/**
+ * @brief   Convert equatorial coordinates of many bodies to horizontal coordinates for many observers
+ *
+ * Same result as coo_get_local_hour_angle () and coo_equ_to_hor () for
+ * each (observer, body) pair, but Greenwich sidereal time is computed once,
+ * and the trigonometric functions of latitudes, longitudes and body
+ * coordinates once per observer or body. Matrices are stored by observer:
+ * pair (i, j) is at index i * n_obj + j. Observers are shared between threads.
+ *
+ * @param[in] jd the dynamic (UT) julian day of the observation
+ * @param[in] L longitudes of the observers, negative towards east
+ * @param[in] phi latitudes of the observers
+ * @param[in] n_obs number of observers
+ * @param[in] alpha bodies right ascensions
+ * @param[in] delta bodies declinations
+ * @param[in] n_obj number of bodies
+ * @param[in] is_apparent set this parameter to 1 if alpha is apparent (e.g. affected by nutation)
+ * @param[in] nthreads number of threads. 0 to use all processors.
+ *
+ * @param[out] A azimuths, between -180 and 180. Can be NULL.
+ * @param[out] h altitudes of the bodies. Can be NULL.
+ *
+ * @return return error code
+ * @retval M_NO_MEM_ERR memory allocation failure
+ * @retval M_NO_ERR The function was successfully executed
+ *
+ * All angle parameters are in degrees. Returned values are in degrees
+ */
+m_err_t
+coo_equ_to_hor_matrix (double jd, const double *L, const double *phi,
+                       size_t n_obs, const double *alpha, const double *delta,
+                       size_t n_obj, int is_apparent, int nthreads,
+                       double *A, double *h)
+{
+    double sid_t;
+    m_err_t err = is_apparent ? sid_get_apparent_gw_sid_time (jd, &sid_t) :
+        sid_get_mean_gw_sid_time (jd, &sid_t);
+    if (err)
+        return err;
+    if (n_obs == 0 || n_obj == 0)
+        return M_NO_ERR;
+
+    double *buf = malloc (4 * n_obj * sizeof *buf);
+    if (!buf)
+        return M_NO_MEM_ERR;
+    double *ca_cd = buf, *sa_cd = buf + n_obj, *sd = buf + 2 * n_obj;
+    double *cd = buf + 3 * n_obj;
+
+    m_sincosd_batch (alpha, n_obj, sa_cd, ca_cd);
+    m_sincosd_batch (delta, n_obj, sd, cd);
+    for (size_t j = 0; j < n_obj; j++) {
+        ca_cd[j] *= cd[j];
+        sa_cd[j] *= cd[j];
+    }
+
+    struct coo_matrix_s ctx = { L, phi, n_obj, s_to_deg (sid_t), ca_cd,
+        sa_cd, sd, A, h
+    };
+    thr_for (n_obs, COO_OBS_GRAIN, nthreads, coo_matrix_rows, &ctx);
+    free (buf);
+    return M_NO_ERR;
+}
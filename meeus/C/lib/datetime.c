@@ -6,6 +6,7 @@
  */
 #include <stdio.h>
 #include <time.h>
+#include <math.h>
 #include "meeus.h"
 
 /**
@@ -254,6 +255,237 @@ dt_jd_to_date (double jd, struct tm *date)
     return dt_get_day_of_year (date, &(date->tm_yday));
 }
 
+/**
+ * @brief sortable key of a date, branch-free
+ *
+ * Year, month and day are clamped first, so that the key cannot overflow
+ * for garbage input: clamped dates are invalid anyway.
+ *
+ * @param[in] Y year (YYYY format)
+ * @param[in] M month (1 to 12)
+ * @param[in] D day of the month
+ *
+ * @return Y * 512 + M * 32 + D
+ */
+static inline int
+dt_ymd_key (int Y, int M, int D)
+{
+    Y = Y < -4713 ? -4713 : Y > 1000000 ? 1000000 : Y;
+    M = M < 0 ? 0 : M > 13 ? 13 : M;
+    D = D < 0 ? 0 : D > 32 ? 32 : D;
+    return Y * 512 + M * 32 + D;
+}
+
+/**
+ * @brief check that a date exists, branch-free
+ *
+ * Any date before 1582 Oct 15 is supposed to be in the Julian calendar.
+ *
+ * @param[in] Y year (YYYY format)
+ * @param[in] M month (1 to 12)
+ * @param[in] D day of the month
+ * @param[in] greg 1 if the date is part of the Gregorian calendar, 0 else
+ *
+ * @return 1 if the date exists, 0 otherwise
+ */
+static inline int
+dt_is_valid_ymd (int Y, int M, int D, int greg)
+{
+    static const int mdays[13] =
+        { 31, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    int leap = ((Y % 4) == 0) & (!greg | ((Y % 100) != 0) | ((Y % 400) == 0));
+    int m = M & -((M >= 1) & (M <= 12));        /* 0 (invalid) indexes a dummy entry */
+    int key = dt_ymd_key (Y, M, D);
+    int gap = (key > 1582 * 512 + 10 * 32 + 4) & (key < 1582 * 512 + 10 * 32 + 15);
+
+    return (m != 0) & (D >= 1) & (D <= mdays[m] + (leap & (m == 2))) & !gap;
+}
+
+/**
+ * @brief get the julian days corresponding to an array of dates
+ *
+ * Batch version of dt_date_to_jd(). Implements Meeus formula 7.1 with
+ * integer arithmetic only and no branch in the loop body, so that the
+ * compiler can vectorize it. An invalid element does not stop the
+ * conversion: it is flagged in err and its jd is meaningless.
+ *
+ * Any date before 1582 Oct 15 is supposed to be in the Julian calendar.
+ * Any date after 1582 Oct 15 is supposed to be in the Gregorian calendar.
+ *
+ * @param[in] year years (YYYY format, e.g. 1515, 2021,...)
+ * @param[in] month months (1 to 12)
+ * @param[in] day days of the month (1 to 31)
+ * @param[in] secs seconds since 0h (0 to 86400)
+ * @param[in] n number of dates
+ * @param[out] jd the julian days
+ * @param[out] err per date error status (M_NO_ERR or M_INVALID_RANGE_ERR)
+ *
+ * @return error status of the function
+ * @retval M_INVALID_RANGE_ERR at least one date is invalid or before Jan 1st -4712 12:00:00
+ * @retval M_NO_ERR all dates were converted
+ */
+m_err_t
+dt_date_to_jd_batch (const int *restrict year, const int *restrict month,
+                     const int *restrict day, const double *restrict secs,
+                     size_t n, double *restrict jd,
+                     unsigned char *restrict err)
+{
+    int n_err = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        int Y = year[i], M = month[i], D = day[i];
+        int greg = dt_ymd_key (Y, M, D) >= 1582 * 512 + 10 * 32 + 15;
+        int ok = (Y >= -4712) & (Y <= 999999) & (secs[i] >= 0)
+            & (secs[i] <= DT_SECS_PER_DAY) & dt_is_valid_ymd (Y, M, D, greg);
+        ok &= (Y > -4712) | (M > 1) | (D > 1) | (secs[i] >= 43200);
+
+        /* Keep the arithmetic in range for invalid elements */
+        Y = ok ? Y : 2000;
+        M = ok ? M : 1;
+        D = ok ? D : 1;
+        int a = (14 - M) / 12;  /* 1 for January and February, 0 otherwise */
+        Y -= a;
+        M += 12 * a;
+        int A = Y / 100;
+        int B = greg * (2 - A + A / 4);
+        int jdn = (1461 * (Y + 4716)) / 4 + (306001 * (M + 1)) / 10000 + D +
+            B - 1524;
+
+        jd[i] = jdn - 0.5 + secs[i] / DT_SECS_PER_DAY;
+        err[i] = ok ? M_NO_ERR : M_INVALID_RANGE_ERR;
+        n_err += !ok;
+    }
+    return n_err ? M_INVALID_RANGE_ERR : M_NO_ERR;
+}
+
+/**
+ * @brief get the dates corresponding to an array of julian days
+ *
+ * Batch version of dt_jd_to_date(). Implements the inverse of Meeus
+ * formula 7.1 (Meeus chapter 7, "Calculation of the calendar date from the JD")
+ * with integer arithmetic only and no branch in the loop body.
+ * An invalid element does not stop the conversion: it is flagged in err.
+ *
+ * @param[in] jd the julian days
+ * @param[in] n number of julian days
+ * @param[out] year years (YYYY format)
+ * @param[out] month months (1 to 12)
+ * @param[out] day days of the month (1 to 31)
+ * @param[out] secs seconds since 0h
+ * @param[out] err per date error status (M_NO_ERR or M_INVALID_RANGE_ERR)
+ *
+ * @return error status of the function
+ * @retval M_INVALID_RANGE_ERR at least one JD is negative or too large
+ * @retval M_NO_ERR all julian days were converted
+ */
+m_err_t
+dt_jd_to_date_batch (const double *restrict jd, size_t n,
+                     int *restrict year, int *restrict month,
+                     int *restrict day, double *restrict secs,
+                     unsigned char *restrict err)
+{
+    int n_err = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        int ok = (jd[i] >= 0) & (jd[i] < 367000000.0);
+        double jdi = (ok ? jd[i] : 0) + 0.5;
+        int Z = (int) jdi;
+        double F = jdi - Z;
+        int greg = Z >= 2299161;
+        int alpha = (4 * (long long) Z - 7468865) / 146097;
+        int A = Z + greg * (1 + alpha - alpha / 4);
+        int B = A + 1524;
+        int C = (20 * (long long) B - 2442) / 7305;
+        int D = (1461 * (long long) C) / 4;
+        int E = (10000 * (B - D)) / 306001;
+        int m = E - 1 - 12 * (E >= 14);
+
+        day[i] = B - D - (306001 * E) / 10000;
+        month[i] = m;
+        year[i] = C - 4716 + (m <= 2);
+        secs[i] = F * DT_SECS_PER_DAY;
+        err[i] = ok ? M_NO_ERR : M_INVALID_RANGE_ERR;
+        n_err += !ok;
+    }
+    return n_err ? M_INVALID_RANGE_ERR : M_NO_ERR;
+}
+
+/**
+ * @brief split a number of seconds since 1970 Jan 1st into a two-part julian day
+ *
+ * @param[in] ts seconds and nanoseconds since 1970 Jan 1st 0h
+ * @param[in] offset offset to add, in seconds (local time offset)
+ * @param[out] jd two-part julian day
+ */
+static void
+dt_timespec_to_jd2 (const struct timespec *ts, long offset,
+                    struct dt_jd2_s *jd)
+{
+    long long secs = (long long) ts->tv_sec + offset;
+    long long days = secs / DT_SECS_PER_DAY;
+    long long sod = secs % DT_SECS_PER_DAY;
+
+    if (sod < 0) {
+        sod += DT_SECS_PER_DAY;
+        days--;
+    }
+    /* 1970 Jan 1st 0h is JD 2440587.5 */
+    jd->day = 2440587 + days;
+    jd->frac = 0.5 + (sod + ts->tv_nsec * 1e-9) / DT_SECS_PER_DAY;
+    if (jd->frac >= 1) {
+        jd->frac -= 1;
+        jd->day++;
+    }
+}
+
+/**
+ * @brief get the local time offset of a time
+ *
+ * @param[in] t time since 1970 Jan 1st
+ * @param[out] offset offset of local time to UTC in seconds
+ *
+ * @return error status of the function
+ * @retval M_IO_ERR local time could not be determined
+ * @retval M_NO_ERR the function executed correctly
+ */
+static m_err_t
+dt_get_local_offset (time_t t, long *offset)
+{
+    struct tm date;
+
+    if (!localtime_r (&t, &date))
+        return M_IO_ERR;
+    *offset = date.tm_gmtoff;
+    return M_NO_ERR;
+}
+
+/**
+ * @brief get the two-part julian day corresponding to the current date
+ *
+ * Reentrant, with the resolution of CLOCK_REALTIME (usually 1 ns).
+ * The julian day is returned as day + frac, so that no precision is lost.
+ *
+ * @param[in] is_local if 1, current date is the local date. If 0 it is the UTC date.
+ * @param[out] jd the two-part julian day
+ *
+ * @return error status of the function
+ * @retval M_IO_ERR the system clock could not be read
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+dt_get_current_jd2 (int is_local, struct dt_jd2_s *jd)
+{
+    struct timespec ts;
+    long offset = 0;
+
+    if (clock_gettime (CLOCK_REALTIME, &ts))
+        return M_IO_ERR;
+    if (is_local && dt_get_local_offset (ts.tv_sec, &offset))
+        return M_IO_ERR;
+    dt_timespec_to_jd2 (&ts, offset, jd);
+    return M_NO_ERR;
+}
+
 /**
  * @brief get the julian day corresponding to the current date
  *
@@ -264,20 +496,86 @@ dt_jd_to_date (double jd, struct tm *date)
  * @param[out] jd the julian day
  *
  * @return error status of the function
- * @retval M_INVALID_RANGE_ERR the current date is before Jan 1st -4712 12:00:00 (negative Julian Day)
+ * @retval M_IO_ERR the system clock could not be read
  * @retval M_NO_ERR the function executed correctly
+ *
+ * @see dt_get_current_jd2 ()
  */
 m_err_t
 dt_get_current_jd (int is_local, double *jd)
 {
-    time_t cur_time;
-    struct tm *date;
+    struct dt_jd2_s jd2;
+    m_err_t err = dt_get_current_jd2 (is_local, &jd2);
 
-    time (&cur_time);
-    if (!is_local)
-        date = gmtime (&cur_time);
-    else
-        date = localtime (&cur_time);
+    if (err)
+        return err;
+    *jd = jd2.day + jd2.frac;
+    return M_NO_ERR;
+}
+
+/**
+ * @brief initialize a clock extrapolating the current date from CLOCK_MONOTONIC
+ *
+ * The clock is anchored on CLOCK_REALTIME, and re-anchored every resync seconds.
+ * Between two anchors, dt_clock_get_jd2() only reads CLOCK_MONOTONIC, which
+ * avoids the local time conversion and is immune to system clock steps.
+ * A clock must not be shared between threads without synchronization: use one per thread.
+ *
+ * @param[out] clk the clock
+ * @param[in] is_local if 1, the clock gives the local date. If 0 it gives the UTC date.
+ * @param[in] resync re-anchoring period in seconds
+ *
+ * @return error status of the function
+ * @retval M_IO_ERR the system clock could not be read
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+dt_clock_init (struct dt_clock_s *clk, int is_local, double resync)
+{
+    struct timespec rt;
+    long offset = 0;
+
+    clk->is_local = is_local;
+    clk->resync = resync;
+    if (clock_gettime (CLOCK_MONOTONIC, &clk->mono)
+        || clock_gettime (CLOCK_REALTIME, &rt))
+        return M_IO_ERR;
+    if (is_local && dt_get_local_offset (rt.tv_sec, &offset))
+        return M_IO_ERR;
+    dt_timespec_to_jd2 (&rt, offset, &clk->anchor);
+    return M_NO_ERR;
+}
 
-    return dt_date_to_jd (date, jd);
+/**
+ * @brief get the current two-part julian day from a clock
+ *
+ * @param[inout] clk the clock, initialized with dt_clock_init ()
+ * @param[out] jd the two-part julian day
+ *
+ * @return error status of the function
+ * @retval M_IO_ERR the system clock could not be read
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+dt_clock_get_jd2 (struct dt_clock_s *clk, struct dt_jd2_s *jd)
+{
+    struct timespec now;
+
+    if (clock_gettime (CLOCK_MONOTONIC, &now))
+        return M_IO_ERR;
+
+    double elapsed = (now.tv_sec - clk->mono.tv_sec) +
+        (now.tv_nsec - clk->mono.tv_nsec) * 1e-9;
+    if (elapsed >= clk->resync) {
+        m_err_t err = dt_clock_init (clk, clk->is_local, clk->resync);
+        if (err)
+            return err;
+        elapsed = 0;
+    }
+
+    double frac = clk->anchor.frac + elapsed / DT_SECS_PER_DAY;
+    double days = floor (frac);
+    jd->day = clk->anchor.day + (long) days;
+    jd->frac = frac - days;
+    return M_NO_ERR;
 }
@@ -6,12 +6,29 @@
 #include <time.h>
 #include "meeus.h"
 
+static dy_src_t dy_deltaT_source = DY_SRC_POLYNOMIAL;
+
+/**
+ * @brief   Select where deltaT comes from
+ *
+ * With DY_SRC_TABLE, deltaT is read from the table loaded with eop_load().
+ * The polynomial expressions are still used outside of the table range.
+ *
+ * @param[in] source DY_SRC_POLYNOMIAL (default) or DY_SRC_TABLE
+ */
+void
+dy_set_deltaT_source (dy_src_t source)
+{
+    dy_deltaT_source = source;
+}
+
 /**
  * @brief   Get deltaT = UT - DT. Difference between Universal Time and Dynamical Time.
  *
  * DeltaT can only be deduced from observation. This function implements polynomial
  * expressions of deltaT found in  https://eclipse.gsfc.nasa.gov/5MCSE/5MCSE-Text11.pdf
- * (authors Meeus and Espenak).
+ * (authors Meeus and Espenak), unless observed data was selected with
+ * dy_set_deltaT_source().
  *
  * @param[in] jde Julian Day Ephemeris (Dynamical Time)
  *
@@ -22,6 +39,11 @@ double
 dy_get_deltaT_seconds (double jde)
 {
     struct tm td;
+    double deltaT;
+
+    if (dy_deltaT_source == DY_SRC_TABLE
+        && eop_get_deltaT_seconds (jde, &deltaT) == M_NO_ERR)
+        return deltaT;
 
     dt_jd_to_date (jde, &td);
     int year = td.tm_year + 1900;
@@ -117,42 +117,73 @@ nut_get_params (double T, double *parm)
 }
 
 /**
- * @brief Get nutation in longitude
+ * @brief Get nutation in longitude and in obliquity
  *
- * @param[in] jde Julian Day Ephemeris (dynamical time)
- * @param[in] accuracy If M_HIGH_ACC, use high accuracy (0.001 arcsecs) computation. If M_LOW_ACC use low accuracy (0.5 arcsecs).
+ * Both series of table 22.A share their arguments: they are summed in one
+ * pass, with one sine and cosine per term.
  *
- * @return nutation in longitude, expressed in arc seconds.
+ * @param[in] jde Julian Day Ephemeris (dynamical time)
+ * @param[in] accuracy If M_HIGH_ACC, use high accuracy (0.001 arcsecs) computation. If M_LOW_ACC use low accuracy (0.5 arcsecs in longitude, 0.1 arcsecs in obliquity).
+ * @param[out] dpsi nutation in longitude, expressed in arc seconds.
+ * @param[out] deps nutation in obliquity, expressed in arc seconds.
  */
-double
-ecl_nut_in_lon (double jde, m_acc_t accuracy)
+void
+ecl_nutation (double jde, m_acc_t accuracy, double *dpsi, double *deps)
 {
     double T = get_century_since_j2000 (jde);
     double parm[5];
-    double mult, arg;
-    double nut = 0.0;
+    double arg, s, c;
 
     nut_get_params (T, parm);
     if (accuracy == M_HIGH_ACC) {       /* precise down to 0.001 arcsecond */
+        double nut_lon = 0.0, nut_obl = 0.0;
         for (int i = 0; i < (sizeof nut_tab) / (sizeof *nut_tab); i++) {
             double *coefs = nut_tab[i];
             arg = 0;
             for (int j = 0; j < (sizeof parm) / (sizeof *parm); j++) {
                 arg += parm[j] * coefs[j];
             }
-            mult = coefs[5] + coefs[6] * T;
-            nut += mult * sind (arg);
+            m_sincosd (arg, &s, &c);
+            nut_lon += (coefs[5] + coefs[6] * T) * s;
+            nut_obl += (coefs[7] + coefs[8] * T) * c;
         }
-        return nut / 10000;
+        *dpsi = nut_lon / 10000;
+        *deps = nut_obl / 10000;
+        return;
     }
 
     /* Mean longitude of the Sun */
     double L = 280.4665 + 36000.7698 * T;
     /* Mean longitude of the Moon */
     double Lprime = 218.3165 + 481267.8813 * T;
+    double sO, cO, s2O, c2O, s2L, c2L, s2Lp, c2Lp;
+    m_sincosd (parm[4], &sO, &cO);
+    m_sincosd (2 * parm[4], &s2O, &c2O);
+    m_sincosd (2 * L, &s2L, &c2L);
+    m_sincosd (2 * Lprime, &s2Lp, &c2Lp);
     /* Accurate to 0.5 arcsecond */
-    return -17.20 * sind (parm[4]) - 1.32 * sind (2 * L) -
-        0.23 * sind (2 * Lprime) + 0.21 * sind (2 * parm[4]);
+    *dpsi = -17.20 * sO - 1.32 * s2L - 0.23 * s2Lp + 0.21 * s2O;
+    /* Accurate to 0.1 arcsecond */
+    *deps = 9.20 * cO + 0.57 * c2L + 0.10 * c2Lp - 0.09 * c2O;
+}
+
+/**
+ * @brief Get nutation in longitude
+ *
+ * @param[in] jde Julian Day Ephemeris (dynamical time)
+ * @param[in] accuracy If M_HIGH_ACC, use high accuracy (0.001 arcsecs) computation. If M_LOW_ACC use low accuracy (0.5 arcsecs).
+ *
+ * @return nutation in longitude, expressed in arc seconds.
+ *
+ * @see ecl_nutation () to get the nutation in obliquity as well
+ */
+double
+ecl_nut_in_lon (double jde, m_acc_t accuracy)
+{
+    double dpsi, deps;
+
+    ecl_nutation (jde, accuracy, &dpsi, &deps);
+    return dpsi;
 }
 
 /**
@@ -162,35 +193,16 @@ ecl_nut_in_lon (double jde, m_acc_t accuracy)
  * @param[in] accuracy If M_HIGH_ACC use high accuracy (0.001 arcsecs) computation. If M_LOW_ACC use low accuracy (0.1 arcsecs).
  *
  * @return nutation in obliquity, expressed in arc seconds.
+ *
+ * @see ecl_nutation () to get the nutation in longitude as well
  */
 double
 ecl_nut_in_obl (double jde, m_acc_t accuracy)
 {
-    double T = get_century_since_j2000 (jde);
-    double parm[5];
-    double mult, arg;
-    double nut = 0.0;
+    double dpsi, deps;
 
-    nut_get_params (T, parm);
-    if (accuracy == M_HIGH_ACC) {       /* Accurate to 0.001 arcseconds */
-        for (int i = 0; i < (sizeof nut_tab) / (sizeof *nut_tab); i++) {
-            double *coefs = nut_tab[i];
-            arg = 0;
-            for (int j = 0; j < (sizeof parm) / (sizeof *parm); j++) {
-                arg += parm[j] * coefs[j];
-            }
-            mult = coefs[7] + coefs[8] * T;
-            nut += mult * cosd (arg);
-        }
-        return nut / 10000;
-    }
-    /* Mean longitude of the Sun */
-    double L = 280.4665 + 36000.7698 * T;
-    /* Mean longitude of the Moon */
-    double Lprime = 218.3165 + 481267.8813 * T;
-    /* Accurate to 0.1 arcsecond */
-    return 9.20 * cosd (parm[4]) + 0.57 * cosd (2 * L) +
-        0.10 * cosd (2 * Lprime) - 0.09 * cosd (2 * parm[4]);
+    ecl_nutation (jde, accuracy, &dpsi, &deps);
+    return deps;
 }
 
 /**
@@ -0,0 +1,409 @@
+/**
+ * @file eop.c
+ * Observed Earth orientation data: deltaT and UT1-UTC.
+ *
+ * Text data files in the usual USNO or IERS formats are compiled once into
+ * a binary table sampled on a uniform grid. The binary table is then memory
+ * mapped and published through an atomic pointer, so that readers never
+ * take a lock: a reload maps the new table, swaps the pointer, and retires
+ * the old table until eop_synchronize() is called (RCU-style).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "meeus.h"
+
+#define EOP_MAGIC "MEEUSEOP"
+#define EOP_VERSION 1
+#define EOP_MAX_LINE 256
+/* suffix of the file written by eop_compile () before it is renamed */
+#define EOP_TMP_SUFFIX ".tmp"
+
+/**
+ * @brief header of a compiled table file. Followed by count doubles (deltaT in seconds).
+ */
+struct eop_header_s
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+    double jd0;
+    double step;
+};
+
+/**
+ * @brief a mapped table
+ */
+struct eop_table_s
+{
+    void *map;
+    size_t map_len;
+    const double *deltaT;
+    uint32_t count;
+    double jd0;
+    double step;
+    double inv_step;
+    struct eop_table_s *next;   /* link in the retired list */
+};
+
+/**
+ * @brief one parsed record of a text data file
+ */
+struct eop_record_s
+{
+    double jd;
+    double deltaT;
+};
+
+static _Atomic (struct eop_table_s *) eop_current = NULL;
+static _Atomic (struct eop_table_s *) eop_retired = NULL;
+
+/**
+ * @brief parse one line of a USNO deltat.data file
+ *
+ * Line format is "YYYY MM DD deltaT", e.g. " 1973  2  1  43.4724".
+ *
+ * @param[in] line the text line
+ * @param[out] rec the parsed record
+ *
+ * @return 1 if the line holds a record, 0 otherwise
+ */
+static int
+eop_parse_usno_deltat (const char *line, struct eop_record_s *rec)
+{
+    int y, m, d;
+    double dt;
+
+    if (sscanf (line, "%d %d %d %lf", &y, &m, &d, &dt) != 4)
+        return 0;
+    if (dt_date_to_jd (&(struct tm) { 0, 0, 0, d, m - 1, y - 1900, 0, 0, 0 },
+                       &rec->jd))
+        return 0;
+    rec->deltaT = dt;
+    return 1;
+}
+
+/**
+ * @brief parse one line of an IERS finals2000A / finals.daily file
+ *
+ * Fixed column format: MJD in columns 8-15, UT1-UTC in columns 59-68.
+ * deltaT is derived as 32.184 + (TAI - UTC) - (UT1 - UTC).
+ *
+ * @param[in] line the text line
+ * @param[out] rec the parsed record
+ *
+ * @return 1 if the line holds a record with a UT1-UTC value, 0 otherwise
+ */
+static int
+eop_parse_iers_finals (const char *line, struct eop_record_s *rec)
+{
+    char field[16];
+    char *end;
+    double mjd, dut1;
+
+    if (strlen (line) < 68)
+        return 0;
+    memcpy (field, line + 7, 8);
+    field[8] = '\0';
+    mjd = strtod (field, &end);
+    if (end == field)
+        return 0;
+    memcpy (field, line + 58, 10);
+    field[10] = '\0';
+    dut1 = strtod (field, &end);
+    if (end == field)
+        return 0;
+
+    rec->jd = mjd + 2400000.5;
+    rec->deltaT = 32.184 + ts_get_tai_utc (rec->jd) - dut1;
+    return 1;
+}
+
+/**
+ * @brief Compile a text Earth orientation data file into a binary table
+ *
+ * The records of the input file are resampled by linear interpolation on a
+ * uniform grid, so that lookups in the compiled table are constant-time.
+ * Records must be sorted by increasing date. The table is written to
+ * bin_path.tmp and renamed to bin_path, so that a table loaded from bin_path
+ * stays valid.
+ *
+ * @param[in] txt_path path of the text data file
+ * @param[in] format format of the text data file
+ * @param[in] step grid step in days. If <= 0, the smallest spacing between two input records is used.
+ * @param[in] bin_path path of the binary table to create
+ *
+ * @return error status of the function
+ * @retval M_IO_ERR a file could not be read or written
+ * @retval M_FORMAT_ERR the input holds less than two records, or is not sorted
+ * @retval M_NO_MEM_ERR memory allocation failed
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+eop_compile (const char *txt_path, eop_fmt_t format, double step,
+             const char *bin_path)
+{
+    char line[EOP_MAX_LINE];
+    struct eop_record_s *recs = NULL, rec;
+    size_t n = 0, cap = 0;
+    double min_step = HUGE_VAL;
+    m_err_t err = M_NO_ERR;
+    FILE *in, *out;
+
+    in = fopen (txt_path, "r");
+    if (!in)
+        return M_IO_ERR;
+
+    while (fgets (line, sizeof line, in)) {
+        int ok = (format == EOP_FMT_IERS_FINALS) ?
+            eop_parse_iers_finals (line, &rec) :
+            eop_parse_usno_deltat (line, &rec);
+        if (!ok)
+            continue;
+        if (n && rec.jd <= recs[n - 1].jd) {
+            err = M_FORMAT_ERR;
+            break;
+        }
+        if (n == cap) {
+            struct eop_record_s *tmp;
+            cap = cap ? 2 * cap : 1024;
+            tmp = realloc (recs, cap * sizeof *recs);
+            if (!tmp) {
+                err = M_NO_MEM_ERR;
+                break;
+            }
+            recs = tmp;
+        }
+        if (n && rec.jd - recs[n - 1].jd < min_step)
+            min_step = rec.jd - recs[n - 1].jd;
+        recs[n++] = rec;
+    }
+    fclose (in);
+    if (!err && n < 2)
+        err = M_FORMAT_ERR;
+    if (err) {
+        free (recs);
+        return err;
+    }
+
+    if (step <= 0)
+        step = min_step;
+
+    struct eop_header_s hdr = {.magic = EOP_MAGIC,.version = EOP_VERSION,
+        .jd0 = recs[0].jd,.step = step
+    };
+    hdr.count = (uint32_t) floor ((recs[n - 1].jd - recs[0].jd) / step) + 1;
+
+    /* a table still mapped from bin_path must not change under its readers:
+       write a new file and rename it over the old one */
+    size_t len = strlen (bin_path);
+    char *tmp_path = malloc (len + sizeof EOP_TMP_SUFFIX);
+    if (!tmp_path) {
+        free (recs);
+        return M_NO_MEM_ERR;
+    }
+    memcpy (tmp_path, bin_path, len);
+    memcpy (tmp_path + len, EOP_TMP_SUFFIX, sizeof EOP_TMP_SUFFIX);
+    out = fopen (tmp_path, "wb");
+    if (!out) {
+        free (tmp_path);
+        free (recs);
+        return M_IO_ERR;
+    }
+    if (fwrite (&hdr, sizeof hdr, 1, out) != 1)
+        err = M_IO_ERR;
+
+    size_t k = 0;
+    for (uint32_t i = 0; !err && i < hdr.count; i++) {
+        double jd = hdr.jd0 + i * step;
+        while (k + 2 < n && recs[k + 1].jd <= jd)
+            k++;
+        double f = (jd - recs[k].jd) / (recs[k + 1].jd - recs[k].jd);
+        double v = recs[k].deltaT + f * (recs[k + 1].deltaT - recs[k].deltaT);
+        if (fwrite (&v, sizeof v, 1, out) != 1)
+            err = M_IO_ERR;
+    }
+    if (!err && (fflush (out) || fsync (fileno (out))))
+        err = M_IO_ERR;
+    if (fclose (out) && !err)
+        err = M_IO_ERR;
+    if (!err && rename (tmp_path, bin_path))
+        err = M_IO_ERR;
+    if (err)
+        unlink (tmp_path);
+    free (tmp_path);
+    free (recs);
+    return err;
+}
+
+/**
+ * @brief push a withdrawn table onto the retired list
+ *
+ * @param[in] old table, or NULL
+ */
+static void
+eop_retire (struct eop_table_s *old)
+{
+    if (!old)
+        return;
+    old->next = atomic_load (&eop_retired);
+    while (!atomic_compare_exchange_weak (&eop_retired, &old->next, old));
+}
+
+/**
+ * @brief Map a compiled table and make it the current one
+ *
+ * Readers running concurrently keep using the previous table, which is
+ * retired until eop_synchronize() is called.
+ *
+ * @param[in] bin_path path of a table created by eop_compile()
+ *
+ * @return error status of the function
+ * @retval M_IO_ERR the file could not be opened or mapped
+ * @retval M_FORMAT_ERR the file is not a valid compiled table
+ * @retval M_NO_MEM_ERR memory allocation failed
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+eop_load (const char *bin_path)
+{
+    struct stat st;
+    struct eop_table_s *tab;
+    const struct eop_header_s *hdr;
+    void *map;
+    int fd;
+
+    fd = open (bin_path, O_RDONLY);
+    if (fd < 0)
+        return M_IO_ERR;
+    if (fstat (fd, &st) || st.st_size < sizeof *hdr) {
+        close (fd);
+        return M_IO_ERR;
+    }
+    map = mmap (NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close (fd);
+    if (map == MAP_FAILED)
+        return M_IO_ERR;
+
+    hdr = map;
+    if (memcmp (hdr->magic, EOP_MAGIC, sizeof hdr->magic)
+        || hdr->version != EOP_VERSION || hdr->count < 2 || hdr->step <= 0
+        || st.st_size != sizeof *hdr + hdr->count * sizeof (double)) {
+        munmap (map, st.st_size);
+        return M_FORMAT_ERR;
+    }
+
+    tab = malloc (sizeof *tab);
+    if (!tab) {
+        munmap (map, st.st_size);
+        return M_NO_MEM_ERR;
+    }
+    tab->map = map;
+    tab->map_len = st.st_size;
+    tab->deltaT = (const double *) (hdr + 1);
+    tab->count = hdr->count;
+    tab->jd0 = hdr->jd0;
+    tab->step = hdr->step;
+    tab->inv_step = 1.0 / hdr->step;
+
+    /* one exchange: readers see either the old or the new table */
+    eop_retire (atomic_exchange_explicit (&eop_current, tab,
+                                          memory_order_acq_rel));
+    return M_NO_ERR;
+}
+
+/**
+ * @brief Withdraw the current table
+ *
+ * The table is retired, not freed: readers may still hold it until
+ * eop_synchronize() is called.
+ */
+void
+eop_unload (void)
+{
+    eop_retire (atomic_exchange_explicit (&eop_current, NULL,
+                                          memory_order_acq_rel));
+}
+
+/**
+ * @brief Free all retired tables
+ *
+ * Must only be called once every reader that may have started before the
+ * last eop_load() or eop_unload() has returned (end of the grace period).
+ */
+void
+eop_synchronize (void)
+{
+    struct eop_table_s *tab = atomic_exchange (&eop_retired, NULL);
+    while (tab) {
+        struct eop_table_s *next = tab->next;
+        munmap (tab->map, tab->map_len);
+        free (tab);
+        tab = next;
+    }
+}
+
+/**
+ * @brief Get deltaT from the current table
+ *
+ * Constant-time linear interpolation in the uniform grid.
+ *
+ * @param[in] jd Julian Day (Universal Time)
+ * @param[out] deltaT deltaT = TT - UT1 in seconds
+ *
+ * @return error status of the function
+ * @retval M_INVALID_RANGE_ERR no table is loaded or jd is outside the table
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+eop_get_deltaT_seconds (double jd, double *deltaT)
+{
+    const struct eop_table_s *tab =
+        atomic_load_explicit (&eop_current, memory_order_acquire);
+    if (!tab)
+        return M_INVALID_RANGE_ERR;
+
+    double x = (jd - tab->jd0) * tab->inv_step;
+    if (!(x >= 0) || x > tab->count - 1)
+        return M_INVALID_RANGE_ERR;
+
+    uint32_t i = (uint32_t) x;
+    if (i == tab->count - 1)
+        i--;
+    double f = x - i;
+    *deltaT = tab->deltaT[i] + f * (tab->deltaT[i + 1] - tab->deltaT[i]);
+    return M_NO_ERR;
+}
+
+/**
+ * @brief Get UT1 - UTC from the current table
+ *
+ * @param[in] jd Julian Day (Universal Time), after 1972 Jan 1st
+ * @param[out] dut1 UT1 - UTC in seconds
+ *
+ * @return error status of the function
+ * @retval M_INVALID_RANGE_ERR no table is loaded, jd is outside the table or before 1972
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+eop_get_ut1_utc_seconds (double jd, double *dut1)
+{
+    double deltaT;
+    m_err_t err;
+
+    if (jd < TS_JD_1972)
+        return M_INVALID_RANGE_ERR;
+    err = eop_get_deltaT_seconds (jd, &deltaT);
+    if (err)
+        return err;
+    *dut1 = 32.184 + ts_get_tai_utc (jd) - deltaT;
+    return M_NO_ERR;
+}
@@ -4,16 +4,44 @@
  *
  */
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 #include <time.h>
 #include "meeus.h"
 
+/* step of the evaluations interpolated by eqt_table (), in days */
+#define EQT_NODE 1.0
+/* number of evaluations per chunk of the parallel loop */
+#define EQT_GRAIN 8
+
+/**
+ * @brief equation of time from the apparent Sun
+ *
+ * Implements Meeus formulas 28.1 and 28.2.
+ *
+ * @param[in] jde Julian Day Ephemeris (Dynamical time)
+ * @param[in] s apparent coordinates of the Sun at jde
+ *
+ * @return equation of time in degrees, between -180 and 180
+ */
+static double
+eqt_from_sun (double jde, const struct sun_apparent_s *s)
+{
+    double tau = get_century_since_j2000 (jde) / 10;
+    double L0 = polynom ((double[]) { 280.4664567, 360007.6982779, 0.03032028,
+                         1.0 / 49931, -1.0 / 15300, -1.0 / 2000000
+                         }, tau, 5);
+
+    return remainder (L0 - 0.0057183 - s->alpha +
+                      arcsec_to_deg (s->dpsi) * m_cosd (s->epsilon), 360);
+}
+
 /**
  * @brief compute equation of time
  *
  * Implements Meeus formulas 28.1 and 28.2
  * @param[in] jde Julian Day Ephemeris (Dynamical time)
- * @param[out] eqt Equation of time in degrees
+ * @param[out] eqt Equation of time in degrees, between -180 and 180
  *
  * @return status of the function
  * @retval M_INVALID_RANGE_ERR error occurred during computation
@@ -22,19 +50,142 @@
 m_err_t
 eqt_equation_of_time (double jde, double *eqt)
 {
-    double tau = get_century_since_j2000 (jde) / 10;
-    double L0 = polynom ((double[]) { 280.4664567, 360007.6982779, 0.03032028,
-                         1.0 / 49931, -1.0 / 15300, -1.0 / 2000000
-                         }, tau, 5);
-    double alpha, delta, epsilon;
-    m_err_t err;
-    err = sun_apparent_equatorial_coord (jde, &alpha, &delta, M_HIGH_ACC);
+    return eqt_eot_declination (jde, M_HIGH_ACC, eqt, NULL);
+}
+
+/**
+ * @brief compute equation of time and declination of the Sun
+ *
+ * Both come from the same evaluation of the apparent Sun, which also gives
+ * the nutation and the true obliquity needed by Meeus 28.1.
+ *
+ * @param[in] jde Julian Day Ephemeris (Dynamical time)
+ * @param[in] accuracy accuracy of the Sun coordinates
+ * @param[out] eqt Equation of time in degrees, between -180 and 180. Can be NULL.
+ * @param[out] delta apparent declination of the Sun in degrees. Can be NULL.
+ *
+ * @return status of the function
+ * @retval M_INVALID_RANGE_ERR error occurred during computation
+ * @retval M_NO_ERR function exited correctly
+ */
+m_err_t
+eqt_eot_declination (double jde, m_acc_t accuracy, double *eqt,
+                     double *delta)
+{
+    struct sun_apparent_s s;
+    m_err_t err = sun_apparent_coord (jde, accuracy, &s);
+
     if (err)
         return err;
-
-    double deltaPsi = ecl_nut_in_lon (jde, 1);
-    err = ecl_true_obl_ecliptic (jde, &epsilon, M_HIGH_ACC);
-    *eqt = rerange (L0 - 0.0057183 - alpha +
-                    deltaPsi / 3600.0 * cosd (epsilon / 3600.0), 360);
+    if (eqt)
+        *eqt = eqt_from_sun (jde, &s);
+    if (delta)
+        *delta = s.delta;
     return M_NO_ERR;
 }
+
+/**
+ * @brief context of the evaluation kernel
+ */
+struct eqt_ctx_s
+{
+    double jde0;
+    double step;
+    m_acc_t accuracy;
+    double *eqt;
+    double *delta;
+};
+
+/**
+ * @brief evaluate the samples [begin, end)
+ *
+ * @param[in] begin first sample
+ * @param[in] end last sample + 1
+ * @param[in] arg context
+ */
+static void
+eqt_eval (size_t begin, size_t end, void *arg)
+{
+    const struct eqt_ctx_s *ctx = arg;
+
+    for (size_t i = begin; i < end; i++)
+        eqt_eot_declination (ctx->jde0 + i * ctx->step, ctx->accuracy,
+                             ctx->eqt ? ctx->eqt + i : NULL,
+                             ctx->delta ? ctx->delta + i : NULL);
+}
+
+/**
+ * @brief evaluate evenly spaced samples, in parallel
+ *
+ * The validity range of the obliquity is checked on the first and the last
+ * samples, so that the parallel loop cannot fail.
+ */
+static m_err_t
+eqt_eval_all (const struct eqt_ctx_s *ctx, size_t n, int nthreads)
+{
+    m_err_t err = eqt_eot_declination (ctx->jde0, ctx->accuracy, NULL, NULL);
+
+    if (!err)
+        err = eqt_eot_declination (ctx->jde0 + (n - 1) * ctx->step,
+                                   ctx->accuracy, NULL, NULL);
+    if (!err)
+        thr_for (n, EQT_GRAIN, nthreads, eqt_eval, (void *) ctx);
+    return err;
+}
+
+/**
+ * @brief Build a table of the equation of time and the declination of the Sun
+ *
+ * Sample i is at jde0 + i * step. Steps of one day or more are evaluated
+ * directly. Shorter steps are interpolated (4 points, cubic) between daily
+ * evaluations, which costs about 1e-6 degree: hourly tables of a year cost
+ * 365 Sun positions instead of 8760.
+ *
+ * @param[in] jde0 Julian Day Ephemeris (Dynamical time) of the first sample
+ * @param[in] step step between samples, in days
+ * @param[in] n number of samples
+ * @param[in] accuracy accuracy of the Sun coordinates
+ * @param[in] nthreads number of threads. 0 to use all processors.
+ * @param[out] eqt Equation of time in degrees, between -180 and 180. Can be NULL.
+ * @param[out] delta apparent declination of the Sun in degrees. Can be NULL.
+ *
+ * @return status of the function
+ * @retval M_INVALID_RANGE_ERR no sample, step not positive or out of range
+ * @retval M_NO_MEM_ERR memory allocation failure
+ * @retval M_NO_ERR function exited correctly
+ */
+m_err_t
+eqt_table (double jde0, double step, size_t n, m_acc_t accuracy,
+           int nthreads, double *eqt, double *delta)
+{
+    if (n == 0 || !(step > 0))
+        return M_INVALID_RANGE_ERR;
+    if (step >= EQT_NODE || n < 4) {
+        struct eqt_ctx_s ctx = { jde0, step, accuracy, eqt, delta };
+        return eqt_eval_all (&ctx, n, nthreads);
+    }
+
+    /* nodes from one before the first sample to three after the node
+       preceding the last one (the last sample may fall on a node) */
+    size_t m = (size_t) floor ((n - 1) * step / EQT_NODE) + 4;
+    double *buf = malloc (2 * m * sizeof *buf);
+    if (!buf)
+        return M_NO_MEM_ERR;
+    struct eqt_ctx_s ctx = { jde0 - EQT_NODE, EQT_NODE, accuracy, buf,
+        buf + m
+    };
+    m_err_t err = eqt_eval_all (&ctx, m, nthreads);
+
+    for (size_t i = 0; !err && i < n; i++) {
+        double t = i * step / EQT_NODE;
+        size_t k = (size_t) t;
+        double x = t - k;
+        /* nodes k - 1 .. k + 2 */
+        if (eqt)
+            eqt[i] = interp4 (buf + k + 1, x);
+        if (delta)
+            delta[i] = interp4 (buf + m + k + 1, x);
+    }
+    free (buf);
+    return err;
+}
@@ -98,12 +98,12 @@ eqx_correct_equinox (double jde0)
 {
     double T = get_century_since_j2000 (jde0);
     double W = 35999.373 * T - 2.47;
-    double deltaLambda = 1 + 0.0334 * cosd (W) + 0.0007 * cosd (2 * W);
+    double deltaLambda = 1 + 0.0334 * m_cosd (W) + 0.0007 * m_cosd (2 * W);
     double S = 0;
 
     for (int i = 0; i < (sizeof eqx_coef) / (sizeof *eqx_coef); i++) {
         double *C = eqx_coef[i];
-        S += C[0] * cosd (C[1] + C[2] * T);
+        S += C[0] * m_cosd (C[1] + C[2] * T);
     }
     return jde0 + 0.00001 * S / deltaLambda;
 }
@@ -128,7 +128,7 @@ eqx_iterate_equinox (double jde0, int k)
     /* We loop until we have a 0.5 seconds precision */
     do {
         sun_apparent_ecliptic_coord (jde_i, &lambda, &beta, &R);
-        correction = 58 * sind (k * 90 - lambda);
+        correction = 58 * m_sind (k * 90 - lambda);
         jde_i += correction;
     } while (correction > 1.0 / DT_SECS_PER_DAY / 2);
 
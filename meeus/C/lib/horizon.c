@@ -0,0 +1,417 @@
+/**
+ * @file horizon.c
+ * Terrain horizons and Sun shading masks.
+ *
+ * Elevations are read from an ESRI ASCII grid in geographic coordinates
+ * (longitudes positive towards east and latitudes, in degrees, as in SRTM
+ * exports). For each site, hzn_profiles () marches one ray per azimuth bin
+ * through the raster and keeps the highest elevation angle, corrected for
+ * the curvature of the Earth and the terrestrial refraction. Sites are
+ * shared between threads.
+ *
+ * A profile is an array of n_bins elevations: bin b covers the azimuths
+ * [b, b + 1) * 360 / n_bins, measured westward from south, so that testing a
+ * direction against the terrain is a single lookup (hzn_is_shaded ()).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <math.h>
+#include "meeus.h"
+
+/* mean radius of the Earth, in meters */
+#define HZN_EARTH_RADIUS 6371000.0
+/* coefficient of terrestrial refraction: light rays bend with a radius
+   1 / HZN_REFRACTION times the radius of the Earth */
+#define HZN_REFRACTION 0.13
+/* beyond 50 cells, the step grows as 1% of the distance */
+#define HZN_STEP_RATIO 0.01
+/* horizon of a direction without terrain, degrees */
+#define HZN_NONE -90.0
+/* number of times processed at once by the mask kernel */
+#define HZN_BLOCK 256
+
+/**
+ * @brief Read an elevation raster
+ *
+ * The ESRI ASCII grid format is a header (ncols, nrows, xllcorner or
+ * xllcenter, yllcorner or yllcenter, cellsize and optionally NODATA_value)
+ * followed by nrows lines of ncols elevations in meters, from north to south.
+ *
+ * @param[in] in input file
+ * @param[out] dem raster, to be freed by hzn_dem_free ()
+ *
+ * @return error status of the function
+ * @retval M_FORMAT_ERR the file is not an ESRI ASCII grid
+ * @retval M_NO_MEM_ERR memory allocation failure
+ * @retval M_IO_ERR read error
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+hzn_dem_read (FILE *in, struct hzn_dem_s *dem)
+{
+    char key[32];
+    double v, ncols = 0, nrows = 0;
+    int center_x = 0, center_y = 0, nkeys = 0;
+
+    memset (dem, 0, sizeof *dem);
+    dem->nodata = NAN;
+    dem->cell = NAN;
+    dem->xll = dem->yll = NAN;
+    /* header lines, until the first number */
+    while (fscanf (in, " %31[A-Za-z_]", key) == 1) {
+        if (fscanf (in, "%lf", &v) != 1)
+            return ferror (in) ? M_IO_ERR : M_FORMAT_ERR;
+        if (!strcasecmp (key, "ncols"))
+            ncols = v;
+        else if (!strcasecmp (key, "nrows"))
+            nrows = v;
+        else if (!strcasecmp (key, "xllcorner")
+                 || !strcasecmp (key, "xllcenter")) {
+            dem->xll = v;
+            center_x = !strcasecmp (key, "xllcenter");
+        } else if (!strcasecmp (key, "yllcorner")
+                   || !strcasecmp (key, "yllcenter")) {
+            dem->yll = v;
+            center_y = !strcasecmp (key, "yllcenter");
+        } else if (!strcasecmp (key, "cellsize"))
+            dem->cell = v;
+        else if (!strcasecmp (key, "nodata_value"))
+            dem->nodata = v;
+        else
+            return M_FORMAT_ERR;
+        nkeys++;
+    }
+    if (nkeys < 5 || !(ncols >= 2) || !(nrows >= 2) || !(dem->cell > 0)
+        || isnan (dem->xll) || isnan (dem->yll))
+        return M_FORMAT_ERR;
+    dem->ncols = (size_t) ncols;
+    dem->nrows = (size_t) nrows;
+    /* corners of the raster */
+    if (center_x)
+        dem->xll -= dem->cell / 2;
+    if (center_y)
+        dem->yll -= dem->cell / 2;
+
+    dem->z = malloc (dem->ncols * dem->nrows * sizeof *dem->z);
+    if (!dem->z)
+        return M_NO_MEM_ERR;
+    dem->zmax = -INFINITY;
+    for (size_t i = 0; i < dem->ncols * dem->nrows; i++) {
+        if (fscanf (in, "%lf", &v) != 1) {
+            m_err_t err = ferror (in) ? M_IO_ERR : M_FORMAT_ERR;
+            hzn_dem_free (dem);
+            return err;
+        }
+        dem->z[i] = v == dem->nodata ? NAN : (float) v;
+        if (v != dem->nodata && v > dem->zmax)
+            dem->zmax = v;
+    }
+    return M_NO_ERR;
+}
+
+/**
+ * @brief Free an elevation raster
+ *
+ * @param[in,out] dem raster read by hzn_dem_read ()
+ */
+void
+hzn_dem_free (struct hzn_dem_s *dem)
+{
+    free (dem->z);
+    dem->z = NULL;
+}
+
+/**
+ * @brief position of a point in the raster
+ *
+ * @param[in] dem raster
+ * @param[in] lon longitude, positive towards east, in degrees
+ * @param[in] lat latitude, in degrees
+ * @param[out] fx column, from the center of the north west cell
+ * @param[out] fy row, from the center of the north west cell
+ *
+ * @return 1 if the point is between the centers of the edge cells, 0 otherwise
+ */
+static int
+hzn_dem_pos (const struct hzn_dem_s *dem, double lon, double lat, double *fx,
+             double *fy)
+{
+    *fx = (lon - dem->xll) / dem->cell - 0.5;
+    *fy = dem->nrows - (lat - dem->yll) / dem->cell - 0.5;
+    return *fx >= 0 && *fy >= 0 && *fx < dem->ncols - 1
+        && *fy < dem->nrows - 1;
+}
+
+/**
+ * @brief Elevation at a point of the raster
+ *
+ * Bilinear interpolation between the centers of the cells.
+ *
+ * @param[in] dem raster
+ * @param[in] lon longitude, positive towards east, in degrees
+ * @param[in] lat latitude, in degrees
+ *
+ * @return elevation in meters, or NAN outside of the raster or next to
+ * cells without data
+ */
+double
+hzn_dem_elevation (const struct hzn_dem_s *dem, double lon, double lat)
+{
+    double fx, fy;
+
+    if (!hzn_dem_pos (dem, lon, lat, &fx, &fy))
+        return NAN;
+    size_t j = (size_t) fx, i = (size_t) fy;
+    double u = fx - j, v = fy - i;
+    const float *z = dem->z + i * dem->ncols + j;
+    return (1 - v) * ((1 - u) * z[0] + u * z[1])
+        + v * ((1 - u) * z[dem->ncols] + u * z[dem->ncols + 1]);
+}
+
+/**
+ * @brief context of the profile kernel
+ */
+struct hzn_prof_ctx_s
+{
+    const struct hzn_dem_s *dem;
+    const double *L;
+    const double *phi;
+    const double *height;
+    size_t n_bins;
+    double max_dist;
+    float *profile;
+};
+
+/**
+ * @brief compute the profiles of the sites [begin, end)
+ *
+ * @param[in] begin first site
+ * @param[in] end last site + 1
+ * @param[in] arg context
+ */
+static void
+hzn_prof_sites (size_t begin, size_t end, void *arg)
+{
+    const struct hzn_prof_ctx_s *ctx = arg;
+    const struct hzn_dem_s *dem = ctx->dem;
+    /* half a cell, in meters */
+    double step0 = deg_to_rad (dem->cell) * HZN_EARTH_RADIUS / 2;
+    /* drop of the terrain under the line of sight, per square meter */
+    double drop = (1 - HZN_REFRACTION) / (2 * HZN_EARTH_RADIUS);
+
+    for (size_t s = begin; s < end; s++) {
+        float *p = ctx->profile + s * ctx->n_bins;
+        double lon0 = -ctx->L[s], lat0 = ctx->phi[s];
+        double z0 = hzn_dem_elevation (dem, lon0, lat0)
+            + (ctx->height ? ctx->height[s] : 0);
+        double k_lon = rad_to_deg (1 / (HZN_EARTH_RADIUS * m_cosd (lat0)));
+        double k_lat = rad_to_deg (1 / HZN_EARTH_RADIUS);
+
+        for (size_t b = 0; b < ctx->n_bins; b++) {
+            double sA, cA, best = -INFINITY;
+            /* center of the bin; towards north is -cos A, towards east -sin A */
+            m_sincosd ((b + 0.5) * 360 / ctx->n_bins, &sA, &cA);
+            for (double d = step0; !isnan (z0) && d <= ctx->max_dist;
+                 d += fmax (step0, d * HZN_STEP_RATIO)) {
+                /* nothing higher can be found further away */
+                if ((dem->zmax - z0) / d < best)
+                    break;
+                double lon = lon0 - d * sA * k_lon, lat = lat0 - d * cA * k_lat;
+                double fx, fy;
+                /* the ray ends at the edge of the raster; voids are skipped */
+                if (!hzn_dem_pos (dem, lon, lat, &fx, &fy))
+                    break;
+                double z = hzn_dem_elevation (dem, lon, lat);
+                if (isnan (z))
+                    continue;
+                double t = (z - z0 - drop * d * d) / d;
+                if (t > best)
+                    best = t;
+            }
+            p[b] = best > -INFINITY ? rad_to_deg (atan (best)) : HZN_NONE;
+        }
+    }
+}
+
+/**
+ * @brief Compute the horizon profiles of sites
+ *
+ * For each site and azimuth bin, the elevation angle of the terrain seen
+ * from the site, along the direction of the center of the bin.
+ * Points of a ray next to cells without data are skipped: the ray goes on
+ * to the edge of the raster or to max_dist. Directions where the ray leaves
+ * the raster at once, and all directions of sites outside the raster or on
+ * a void, have a profile of -90 degrees.
+ *
+ * @param[in] dem elevation raster
+ * @param[in] L longitudes of the sites, negative towards east
+ * @param[in] phi latitudes of the sites
+ * @param[in] height heights of the observers above the ground, in meters. Can be NULL for 0.
+ * @param[in] n_sites number of sites
+ * @param[in] n_bins number of azimuth bins, e.g. 360
+ * @param[in] max_dist distance up to which the terrain is searched, in meters
+ * @param[in] nthreads number of threads. 0 to use all processors.
+ * @param[out] profile elevations of the horizon, in degrees, n_sites x n_bins, site by site
+ *
+ * @return error status of the function
+ * @retval M_INVALID_RANGE_ERR no bin or distance not positive
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+hzn_profiles (const struct hzn_dem_s *dem, const double *L, const double *phi,
+              const double *height, size_t n_sites, size_t n_bins,
+              double max_dist, int nthreads, float *profile)
+{
+    struct hzn_prof_ctx_s ctx = { dem, L, phi, height, n_bins, max_dist,
+        profile
+    };
+
+    if (n_bins == 0 || !(max_dist > 0))
+        return M_INVALID_RANGE_ERR;
+    thr_for (n_sites, 1, nthreads, hzn_prof_sites, &ctx);
+    return M_NO_ERR;
+}
+
+/**
+ * @brief Test a direction against a horizon profile
+ *
+ * @param[in] profile horizon profile of the site, from hzn_profiles ()
+ * @param[in] n_bins number of azimuth bins
+ * @param[in] A azimuth, measured westward from south, in degrees
+ * @param[in] h altitude, in degrees
+ *
+ * @return 1 if the direction is hidden by the terrain, 0 otherwise
+ */
+int
+hzn_is_shaded (const float *profile, size_t n_bins, double A, double h)
+{
+    size_t b = (size_t) (rerange (A, 360) * n_bins / 360);
+
+    return h <= profile[b < n_bins ? b : 0];
+}
+
+/**
+ * @brief context of the mask kernel
+ */
+struct hzn_mask_ctx_s
+{
+    const float *profile;
+    size_t n_bins;
+    const double *L;
+    const double *phi;
+    const double *H0;           /* hour angle of the Sun at Greenwich, per time */
+    const double *sd;           /* sine of the declination, per time */
+    const double *cd;           /* cosine of the declination, per time */
+    size_t nt;
+    const struct ref_table_s *ref;      /* refraction, standard atmosphere */
+    unsigned char *mask;
+};
+
+/**
+ * @brief compute the masks of the sites [begin, end)
+ *
+ * @param[in] begin first site
+ * @param[in] end last site + 1
+ * @param[in] arg context
+ */
+static void
+hzn_mask_sites (size_t begin, size_t end, void *arg)
+{
+    const struct hzn_mask_ctx_s *ctx = arg;
+    double H[HZN_BLOCK], sH[HZN_BLOCK], cH[HZN_BLOCK], x[HZN_BLOCK];
+    double y[HZN_BLOCK], z[HZN_BLOCK], A[HZN_BLOCK], h[HZN_BLOCK];
+
+    for (size_t s = begin; s < end; s++) {
+        const float *p = ctx->profile + s * ctx->n_bins;
+        unsigned char *mask = ctx->mask + s * ctx->nt;
+        double sp, cp;
+        m_sincosd (ctx->phi[s], &sp, &cp);
+        for (size_t t0 = 0; t0 < ctx->nt; t0 += HZN_BLOCK) {
+            size_t m = ctx->nt - t0 < HZN_BLOCK ? ctx->nt - t0 : HZN_BLOCK;
+            const double *sd = ctx->sd + t0, *cd = ctx->cd + t0;
+            for (size_t i = 0; i < m; i++)
+                H[i] = ctx->H0[t0 + i] - ctx->L[s];
+            m_sincosd_batch (H, m, sH, cH);
+            /* Meeus 13.5 and 13.6, multiplied by cos (delta) */
+            for (size_t i = 0; i < m; i++) {
+                y[i] = cd[i] * sH[i];
+                x[i] = cd[i] * cH[i] * sp - sd[i] * cp;
+                z[i] = sp * sd[i] + cp * cd[i] * cH[i];
+            }
+            m_asind_batch (z, m, h);
+            m_atan2d_batch (y, x, m, A);
+            for (size_t i = 0; i < m; i++) {
+                double ha = h[i] >= -1 ? h[i]
+                    + ref_table_true_to_apparent (ctx->ref, h[i]) / 60 : h[i];
+                mask[t0 + i] = ha > 0 && !hzn_is_shaded (p, ctx->n_bins,
+                                                         A[i], ha);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Compute when the Sun shines on sites
+ *
+ * Time i is jd + i * step. The Sun is lit at a site when its apparent
+ * (refracted) center is above the astronomical horizon and above the
+ * terrain. The Sun is computed once for all sites, with eqt_table ():
+ * the hour angle is the mean hour angle plus the equation of time. The
+ * parallax of the Sun (9") is neglected.
+ *
+ * @param[in] profile horizon profiles, n_sites x n_bins, from hzn_profiles ()
+ * @param[in] n_bins number of azimuth bins
+ * @param[in] L longitudes of the sites, negative towards east
+ * @param[in] phi latitudes of the sites
+ * @param[in] n_sites number of sites
+ * @param[in] jd (UT) julian day of the first time
+ * @param[in] step step between times, in days
+ * @param[in] nt number of times
+ * @param[in] accuracy accuracy of the Sun coordinates
+ * @param[in] nthreads number of threads. 0 to use all processors.
+ * @param[out] mask 1 when the Sun shines, 0 otherwise, n_sites x nt, site by site
+ *
+ * @return error status of the function
+ * @retval M_INVALID_RANGE_ERR no time, no bin, step not positive or time out of range
+ * @retval M_NO_MEM_ERR memory allocation failure
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+hzn_sun_masks (const float *profile, size_t n_bins, const double *L,
+               const double *phi, size_t n_sites, double jd, double step,
+               size_t nt, m_acc_t accuracy, int nthreads,
+               unsigned char *mask)
+{
+    if (nt == 0 || n_bins == 0)
+        return M_INVALID_RANGE_ERR;
+    double *buf = malloc (4 * nt * sizeof *buf);
+    struct ref_table_s *ref = malloc (sizeof *ref);
+    if (!buf || !ref) {
+        free (buf);
+        free (ref);
+        return M_NO_MEM_ERR;
+    }
+    double *eqt = buf, *delta = buf + nt, *sd = buf + 2 * nt,
+        *cd = buf + 3 * nt;
+    m_err_t err = eqt_table (dy_ut_to_dt (jd), step, nt, accuracy, nthreads,
+                             eqt, delta);
+
+    if (!err) {
+        double f = jd - floor (jd);
+        m_sincosd_batch (delta, nt, sd, cd);
+        /* mean hour angle at Greenwich (0 at 12h UT) plus equation of time */
+        for (size_t i = 0; i < nt; i++)
+            eqt[i] += 360 * (f + i * step);
+        ref_table_init (REF_STD_PRESSURE, REF_STD_TEMPERATURE, ref);
+        struct hzn_mask_ctx_s ctx = { profile, n_bins, L, phi, eqt, sd, cd,
+            nt, ref, mask
+        };
+        thr_for (n_sites, 1, nthreads, hzn_mask_sites, &ctx);
+    }
+    free (ref);
+    free (buf);
+    return err;
+}
@@ -0,0 +1,307 @@
+/**
+ * @file irradiance.c
+ * Sun incidence angle and extraterrestrial irradiance on tilted panels.
+ *
+ * irr_sun () computes, for a site and evenly spaced times, the unit vector
+ * towards the apparent (topocentric, refracted) Sun, the air mass and the
+ * extraterrestrial irradiance. The Sun and the sidereal time are computed at
+ * 0h UT of each day and interpolated, so that a year at one minute steps
+ * costs about 370 Sun positions.
+ *
+ * irr_incidence () then evaluates all panels at all times as a dense
+ * product of the Sun vectors by the panel normals: panels are processed by
+ * tiles that stay in cache while the times of a chunk are swept, and chunks
+ * of times are shared between threads.
+ *
+ * Vectors are in the horizontal frame: x towards south, y towards west, z
+ * towards the zenith.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+#include "meeus.h"
+
+/* solar constant: total solar irradiance at 1 AU, W/m2 (Kopp and Lean, 2011) */
+#define IRR_SOLAR_CONSTANT 1361.0
+/* rate of the sidereal time, degrees per (UT) day */
+#define IRR_SID_RATE 360.98564736629
+/* refraction is not applied below this true altitude, degrees */
+#define IRR_REF_MIN -1.0
+/* number of times processed at once by the Sun kernel */
+#define IRR_BLOCK 256
+/* number of panels of a tile of the incidence kernel */
+#define IRR_TILE 512
+/* number of times per chunk of the incidence kernel */
+#define IRR_ROWS 64
+
+/**
+ * @brief Compute the normal of a panel
+ *
+ * @param[in] tilt angle of the panel with the horizontal, in degrees
+ * @param[in] A azimuth the panel faces, measured westward from south, in degrees
+ * @param[out] n unit normal, array of 3 (south, west, zenith)
+ */
+void
+irr_panel_normal (double tilt, double A, double *n)
+{
+    double st, ct, sA, cA;
+
+    m_sincosd (tilt, &st, &ct);
+    m_sincosd (A, &sA, &cA);
+    n[0] = st * cA;
+    n[1] = st * sA;
+    n[2] = ct;
+}
+
+/**
+ * @brief relative optical air mass
+ *
+ * Kasten and Young (1989), valid down to the horizon.
+ *
+ * @param[in] h apparent altitude, in degrees
+ *
+ * @return air mass, or NAN below the horizon
+ */
+static double
+irr_air_mass (double h)
+{
+    if (!(h > 0))
+        return NAN;
+    return 1 / (m_sind (h) + 0.50572 * pow (h + 6.07995, -1.6364));
+}
+
+/**
+ * @brief context of the Sun kernel
+ */
+struct irr_sun_ctx_s
+{
+    double jd;                  /* first time */
+    double step;
+    double node0;               /* (UT) julian day of the first node */
+    const double *g;            /* sidereal time - alpha - IRR_SID_RATE (t - node0), per node */
+    const double *delta;        /* declination, per node */
+    const double *R;            /* radius vector, per node */
+    double L;
+    double sp, cp;              /* sine and cosine of the latitude */
+    struct plx_site_s site;
+    struct irr_sun_s *sun;
+};
+
+/**
+ * @brief fill the times [begin, end)
+ *
+ * @param[in] begin first time
+ * @param[in] end last time + 1
+ * @param[in] arg context
+ */
+static void
+irr_sun_times (size_t begin, size_t end, void *arg)
+{
+    const struct irr_sun_ctx_s *ctx = arg;
+    static const double zero[IRR_BLOCK];
+    double H[IRR_BLOCK], d[IRR_BLOCK], R[IRR_BLOCK], a[IRR_BLOCK];
+    double dt[IRR_BLOCK], sH[IRR_BLOCK], cH[IRR_BLOCK], sd[IRR_BLOCK];
+    double cd[IRR_BLOCK], h[IRR_BLOCK];
+
+    for (size_t i0 = begin; i0 < end; i0 += IRR_BLOCK) {
+        size_t m = end - i0 < IRR_BLOCK ? end - i0 : IRR_BLOCK;
+        for (size_t i = 0; i < m; i++) {
+            double t = ctx->jd + (i0 + i) * ctx->step - ctx->node0;
+            size_t k = (size_t) t;
+            H[i] = interp4 (ctx->g + k, t - k) + IRR_SID_RATE * t - ctx->L;
+            d[i] = interp4 (ctx->delta + k, t - k);
+            R[i] = interp4 (ctx->R + k, t - k);
+        }
+        /* topocentric: a is the parallax in right ascension */
+        plx_equ_to_topo_batch (&ctx->site, H, zero, d, R, m, a, dt);
+        for (size_t i = 0; i < m; i++)
+            H[i] -= a[i];
+        m_sincosd_batch (H, m, sH, cH);
+        m_sincosd_batch (dt, m, sd, cd);
+        for (size_t i = 0; i < m; i++) {
+            struct irr_sun_s *s = &ctx->sun[i0 + i];
+            s->s[0] = ctx->sp * cd[i] * cH[i] - ctx->cp * sd[i];
+            s->s[1] = cd[i] * sH[i];
+            s->s[2] = ctx->sp * sd[i] + ctx->cp * cd[i] * cH[i];
+            a[i] = s->s[2];
+        }
+        m_asind_batch (a, m, h);
+        for (size_t i = 0; i < m; i++)
+            if (h[i] >= IRR_REF_MIN)
+                h[i] += ref_refraction_true_to_apparent (h[i], 1) / 60;
+        m_sincosd_batch (h, m, sd, cd);
+        for (size_t i = 0; i < m; i++) {
+            struct irr_sun_s *s = &ctx->sun[i0 + i];
+            /* same azimuth, apparent altitude */
+            double ch = hypot (s->s[0], s->s[1]);
+            s->s[0] = ch > 0 ? s->s[0] * cd[i] / ch : 0;
+            s->s[1] = ch > 0 ? s->s[1] * cd[i] / ch : 0;
+            s->s[2] = sd[i];
+            s->h = h[i];
+            s->air_mass = irr_air_mass (h[i]);
+            s->E0 = IRR_SOLAR_CONSTANT / (R[i] * R[i]);
+        }
+    }
+}
+
+/**
+ * @brief Compute the apparent Sun seen from a site at evenly spaced times
+ *
+ * Time i is jd + i * step. The Sun is topocentric (Meeus chapter 40) and
+ * its altitude is corrected for the refraction (Meeus 16.4). Compared to
+ * sun_apparent_equatorial_coord (), coo_get_local_hour_angle (),
+ * plx_equ_to_topo () and coo_equ_to_hor () at each time, the interpolation
+ * costs less than 0.01".
+ *
+ * @param[in] jd (UT) julian day of the first time
+ * @param[in] step step between times, in days
+ * @param[in] n number of times
+ * @param[in] L longitude of the site, negative towards east
+ * @param[in] phi latitude of the site, in degrees
+ * @param[in] height height of the site above sea level, in meters
+ * @param[in] accuracy accuracy of the Sun coordinates
+ * @param[in] nthreads number of threads. 0 to use all processors.
+ * @param[out] sun Sun at each time
+ *
+ * @return error status of the function
+ * @retval M_INVALID_RANGE_ERR no time, negative step or time out of range
+ * @retval M_NO_MEM_ERR memory allocation failure
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+irr_sun (double jd, double step, size_t n, double L, double phi,
+         double height, m_acc_t accuracy, int nthreads, struct irr_sun_s *sun)
+{
+    struct irr_sun_ctx_s ctx = { jd, step, floor (jd - 0.5) - 0.5 };
+    struct sun_apparent_s s;
+    m_err_t err = M_NO_ERR;
+
+    if (n == 0 || !(step >= 0))
+        return M_INVALID_RANGE_ERR;
+
+    /* nodes at 0h UT, from one before the first time to two after the last */
+    size_t m = (size_t) (floor (jd + (n - 1) * step - ctx.node0)) + 3;
+    double *buf = malloc (3 * m * sizeof *buf);
+    if (!buf)
+        return M_NO_MEM_ERR;
+    double *g = buf, *delta = buf + m, *R = buf + 2 * m;
+    for (size_t k = 0; k < m; k++) {
+        double jd_k = ctx.node0 + k, sid_t = 0;
+        err = sun_apparent_coord (dy_ut_to_dt (jd_k), accuracy, &s);
+        if (!err)
+            err = sid_get_apparent_gw_sid_time (jd_k, &sid_t);
+        if (err)
+            break;
+        g[k] = s_to_deg (sid_t) - s.alpha - IRR_SID_RATE * k;
+        /* no jump of 360 degrees between nodes */
+        if (k > 0)
+            g[k] = g[k - 1] + remainder (g[k] - g[k - 1], 360);
+        delta[k] = s.delta;
+        R[k] = s.R;
+    }
+
+    if (!err) {
+        ctx.g = g;
+        ctx.delta = delta;
+        ctx.R = R;
+        ctx.L = L;
+        m_sincosd (phi, &ctx.sp, &ctx.cp);
+        plx_site_init (phi, height, &ctx.site);
+        ctx.sun = sun;
+        thr_for (n, IRR_BLOCK, nthreads, irr_sun_times, &ctx);
+    }
+    free (buf);
+    return err;
+}
+
+/**
+ * @brief context of the incidence kernel
+ */
+struct irr_inc_ctx_s
+{
+    const struct irr_sun_s *sun;
+    const double *nx;           /* normals, component by component */
+    const double *ny;
+    const double *nz;
+    size_t np;
+    double *cos_inc;
+    double *poa;
+};
+
+/**
+ * @brief fill the rows [begin, end) of the matrices
+ *
+ * @param[in] begin first time
+ * @param[in] end last time + 1
+ * @param[in] arg context
+ */
+static void
+irr_inc_rows (size_t begin, size_t end, void *arg)
+{
+    const struct irr_inc_ctx_s *ctx = arg;
+    const size_t np = ctx->np;
+    const double *restrict nx = ctx->nx, *restrict ny = ctx->ny;
+    const double *restrict nz = ctx->nz;
+
+    for (size_t p0 = 0; p0 < np; p0 += IRR_TILE) {
+        size_t p1 = np - p0 < IRR_TILE ? np : p0 + IRR_TILE;
+        for (size_t t = begin; t < end; t++) {
+            const struct irr_sun_s *s = &ctx->sun[t];
+            double sx = s->s[0], sy = s->s[1], sz = s->s[2];
+            /* no direct light at night */
+            double e = s->h > 0 ? s->E0 : 0;
+            if (ctx->cos_inc) {
+                double *restrict c = ctx->cos_inc + t * np;
+                for (size_t p = p0; p < p1; p++)
+                    c[p] = sx * nx[p] + sy * ny[p] + sz * nz[p];
+            }
+            if (ctx->poa) {
+                double *restrict q = ctx->poa + t * np;
+                for (size_t p = p0; p < p1; p++) {
+                    double d = sx * nx[p] + sy * ny[p] + sz * nz[p];
+                    q[p] = d > 0 ? e * d : 0;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Compute the incidence and the irradiance on panels
+ *
+ * Matrices are stored time by time: element (t, p) is at index t * np + p.
+ *
+ * @param[in] sun Sun at each time, from irr_sun ()
+ * @param[in] nt number of times
+ * @param[in] n unit normals of the panels, np x 3 (see irr_panel_normal ())
+ * @param[in] np number of panels
+ * @param[in] nthreads number of threads. 0 to use all processors.
+ * @param[out] cos_inc cosines of the incidence angles, nt x np. Negative when the Sun is behind the panel. Can be NULL.
+ * @param[out] poa extraterrestrial irradiance on the plane of the panels, in W/m2, nt x np. 0 when the Sun is behind the panel or below the horizon. Can be NULL.
+ *
+ * @return error status of the function
+ * @retval M_NO_MEM_ERR memory allocation failure
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+irr_incidence (const struct irr_sun_s *sun, size_t nt, const double *n,
+               size_t np, int nthreads, double *cos_inc, double *poa)
+{
+    if (np == 0)
+        return M_NO_ERR;
+    double *buf = malloc (3 * np * sizeof *buf);
+    if (!buf)
+        return M_NO_MEM_ERR;
+    for (size_t p = 0; p < np; p++) {
+        buf[p] = n[3 * p];
+        buf[np + p] = n[3 * p + 1];
+        buf[2 * np + p] = n[3 * p + 2];
+    }
+    struct irr_inc_ctx_s ctx = { sun, buf, buf + np, buf + 2 * np, np,
+        cos_inc, poa
+    };
+    thr_for (nt, IRR_ROWS, nthreads, irr_inc_rows, &ctx);
+    free (buf);
+    return M_NO_ERR;
+}
@@ -0,0 +1,245 @@
+/**
+ * @file iso8601.c
+ * ISO 8601 date and time strings.
+ *
+ * Hand-written, locale independent parser and formatter, going directly
+ * to and from Julian Days without struct tm nor any allocation.
+ * As mandated by ISO 8601, dates are in the proleptic Gregorian calendar,
+ * including before 1582 Oct 15.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include <math.h>
+#include "meeus.h"
+
+/* JD of 1970 Jan 1st, 0h */
+#define ISO_JD_UNIX_EPOCH 2440587.5
+
+static const double iso_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+    1e13, 1e14, 1e15, 1e16, 1e17, 1e18
+};
+
+/**
+ * @brief days since 1970 Jan 1st of a proleptic Gregorian date
+ *
+ * @param[in] y year
+ * @param[in] m month (1 to 12)
+ * @param[in] d day of the month (1 to 31)
+ *
+ * @return number of days since 1970 Jan 1st
+ */
+static long
+iso_days_from_civil (long y, int m, int d)
+{
+    y -= m <= 2;
+    long era = (y >= 0 ? y : y - 399) / 400;
+    long yoe = y - era * 400;
+    long doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+/**
+ * @brief proleptic Gregorian date of a number of days since 1970 Jan 1st
+ *
+ * @param[in] z number of days since 1970 Jan 1st
+ * @param[out] y year
+ * @param[out] m month (1 to 12)
+ * @param[out] d day of the month (1 to 31)
+ */
+static void
+iso_civil_from_days (long z, long *y, int *m, int *d)
+{
+    z += 719468;
+    long era = (z >= 0 ? z : z - 146096) / 146097;
+    long doe = z - era * 146097;
+    long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    long mp = (5 * doy + 2) / 153;
+    *d = doy - (153 * mp + 2) / 5 + 1;
+    *m = mp < 10 ? mp + 3 : mp - 9;
+    *y = yoe + era * 400 + (*m <= 2);
+}
+
+/**
+ * @brief read exactly n decimal digits
+ *
+ * @param[in] s string
+ * @param[in] n number of digits
+ * @param[out] v value
+ *
+ * @return 1 if the n characters are digits, 0 otherwise
+ */
+static inline int
+iso_digits (const char *s, int n, int *v)
+{
+    int r = 0;
+    for (int i = 0; i < n; i++) {
+        unsigned c = (unsigned char) s[i] - '0';
+        if (c > 9)
+            return 0;
+        r = r * 10 + c;
+    }
+    *v = r;
+    return 1;
+}
+
+/**
+ * @brief Parse an ISO 8601 date and time
+ *
+ * Accepted form is the extended format YYYY-MM-DD[(T| )hh:mm[:ss[(.|,)f...]]][Z|(+|-)hh[[:]mm]].
+ * Time defaults to 0h, offset to UTC. A second of 60 (leap second) is accepted.
+ * Parsing stops at the first character that cannot belong to the date,
+ * so that a string can be parsed in place in a larger buffer (e.g. CSV line).
+ *
+ * @param[in] s string to parse. Need not be nul-terminated.
+ * @param[in] len maximum number of characters to read
+ * @param[out] jd julian day (UTC if an offset or Z was given)
+ * @param[out] consumed number of characters parsed. Can be NULL.
+ *
+ * @return error status of the function
+ * @retval M_FORMAT_ERR the string is not a valid ISO 8601 date
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+iso_parse (const char *s, size_t len, double *jd, size_t *consumed)
+{
+    int Y, M, D, h = 0, m = 0, sec = 0, oh = 0, om = 0;
+    double frac = 0;
+    long offset = 0;
+    size_t i = 10;
+    static const int mdays[13] =
+        { 0, 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+    if (len < 10 || s[4] != '-' || s[7] != '-' || !iso_digits (s, 4, &Y)
+        || !iso_digits (s + 5, 2, &M) || !iso_digits (s + 8, 2, &D))
+        return M_FORMAT_ERR;
+    if (M < 1 || M > 12 || D < 1 || D > mdays[M]
+        || (M == 2 && D == 29
+            && ((Y % 4) != 0 || ((Y % 100) == 0 && (Y % 400) != 0))))
+        return M_FORMAT_ERR;
+
+    if (i + 5 < len && (s[i] == 'T' || s[i] == ' ')
+        && s[i + 3] == ':' && iso_digits (s + i + 1, 2, &h)
+        && iso_digits (s + i + 4, 2, &m)) {
+        i += 6;
+        if (i + 2 < len && s[i] == ':' && iso_digits (s + i + 1, 2, &sec)) {
+            i += 3;
+            if (i < len && (s[i] == '.' || s[i] == ',')) {
+                uint64_t f = 0;
+                int n = 0;
+                for (i++; i < len && (unsigned) (s[i] - '0') <= 9; i++) {
+                    if (n < 18) {
+                        f = f * 10 + (s[i] - '0');
+                        n++;
+                    }
+                }
+                if (n == 0)
+                    return M_FORMAT_ERR;
+                frac = f / iso_pow10[n];
+            }
+        }
+        if (h > 24 || m > 59 || sec > 60
+            || (h == 24 && (m != 0 || sec != 0 || frac != 0)))
+            return M_FORMAT_ERR;
+
+        if (i < len && s[i] == 'Z')
+            i++;
+        else if (i + 2 < len && (s[i] == '+' || s[i] == '-')
+                 && iso_digits (s + i + 1, 2, &oh)) {
+            int sign = s[i] == '-' ? -1 : 1;
+            i += 3;
+            if (i + 2 < len && s[i] == ':' && iso_digits (s + i + 1, 2, &om))
+                i += 3;
+            else if (i + 1 < len && iso_digits (s + i, 2, &om))
+                i += 2;
+            if (oh > 23 || om > 59)
+                return M_FORMAT_ERR;
+            offset = sign * (oh * 3600L + om * 60L);
+        }
+    }
+
+    *jd = iso_days_from_civil (Y, M, D) + ISO_JD_UNIX_EPOCH +
+        ((h * 3600L + m * 60L + sec - offset) + frac) / DT_SECS_PER_DAY;
+    if (consumed)
+        *consumed = i;
+    return M_NO_ERR;
+}
+
+/**
+ * @brief Format a julian day as an ISO 8601 UTC date and time
+ *
+ * Output is fixed width: YYYY-MM-DDThh:mm:ssZ, with frac_digits decimals
+ * of seconds inserted before the Z if frac_digits > 0. Seconds are rounded
+ * to the requested number of decimals.
+ *
+ * @param[in] jd julian day
+ * @param[in] frac_digits number of decimals of seconds (0 to 9)
+ * @param[out] buf output buffer. Receives a nul-terminated string.
+ * @param[in] size size of buf. At least 21 + frac_digits + (frac_digits > 0).
+ *
+ * @return error status of the function
+ * @retval M_INVALID_RANGE_ERR year outside of 0-9999, frac_digits out of range or buf too small
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+iso_format (double jd, int frac_digits, char *buf, size_t size)
+{
+    static const char digits[] = "0123456789";
+    long Y;
+    int M, D;
+
+    if (frac_digits < 0 || frac_digits > 9
+        || size < 21 + frac_digits + (frac_digits > 0))
+        return M_INVALID_RANGE_ERR;
+
+    double x = jd - ISO_JD_UNIX_EPOCH;
+    double day = floor (x);
+    int64_t scale = (int64_t) iso_pow10[frac_digits];
+    int64_t units = llround ((x - day) * DT_SECS_PER_DAY * scale);
+    if (units >= DT_SECS_PER_DAY * scale) {
+        units -= DT_SECS_PER_DAY * scale;
+        day += 1;
+    }
+    iso_civil_from_days ((long) day, &Y, &M, &D);
+    if (Y < 0 || Y > 9999)
+        return M_INVALID_RANGE_ERR;
+
+    int64_t secs = units / scale;
+    int64_t frac = units % scale;
+    int h = secs / 3600, m = (secs / 60) % 60, s = secs % 60;
+    char *p = buf;
+
+    *p++ = digits[Y / 1000];
+    *p++ = digits[(Y / 100) % 10];
+    *p++ = digits[(Y / 10) % 10];
+    *p++ = digits[Y % 10];
+    *p++ = '-';
+    *p++ = digits[M / 10];
+    *p++ = digits[M % 10];
+    *p++ = '-';
+    *p++ = digits[D / 10];
+    *p++ = digits[D % 10];
+    *p++ = 'T';
+    *p++ = digits[h / 10];
+    *p++ = digits[h % 10];
+    *p++ = ':';
+    *p++ = digits[m / 10];
+    *p++ = digits[m % 10];
+    *p++ = ':';
+    *p++ = digits[s / 10];
+    *p++ = digits[s % 10];
+    if (frac_digits) {
+        *p++ = '.';
+        for (int i = frac_digits - 1; i >= 0; i--) {
+            p[i] = digits[frac % 10];
+            frac /= 10;
+        }
+        p += frac_digits;
+    }
+    *p++ = 'Z';
+    *p = '\0';
+    return M_NO_ERR;
+}
@@ -0,0 +1,187 @@
+/**
+ * @file mtime.c
+ * Compact integer timestamps.
+ *
+ * m_time_t counts nanoseconds since J2000.0 (JD 2451545.0) in a 64-bit
+ * integer. It covers about 292 years on each side of J2000 (1708 to 2292)
+ * with an exact 1 ns resolution, where a double JD only resolves about
+ * 40 microseconds. The time scale (UT, TT,...) is the one of the JD it
+ * was built from.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <math.h>
+#include "meeus.h"
+
+/* J2000.0 is 2000 Jan 1st 12h, 946728000 s after 1970 Jan 1st 0h */
+#define MT_UNIX_J2000 946728000LL
+
+/**
+ * @brief Convert a julian day to a timestamp
+ *
+ * @param[in] jd julian day
+ * @param[out] t timestamp, rounded to the nanosecond
+ *
+ * @return error status of the function
+ * @retval M_INVALID_RANGE_ERR jd is out of the m_time_t range
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+mt_from_jd (double jd, m_time_t *t)
+{
+    double days = jd - MT_JD_EPOCH;
+    double whole = floor (days);
+
+    if (!(fabs (days) < MT_MAX_DAYS))
+        return M_INVALID_RANGE_ERR;
+    *t = (int64_t) whole * MT_NS_PER_DAY +
+        llround ((days - whole) * MT_NS_PER_DAY);
+    return M_NO_ERR;
+}
+
+/**
+ * @brief Convert a two-part julian day to a timestamp
+ *
+ * No precision is lost from the fractional part.
+ *
+ * @param[in] jd two-part julian day
+ * @param[out] t timestamp, rounded to the nanosecond
+ *
+ * @return error status of the function
+ * @retval M_INVALID_RANGE_ERR jd is out of the m_time_t range
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+mt_from_jd2 (const struct dt_jd2_s *jd, m_time_t *t)
+{
+    long days = jd->day - (long) MT_JD_EPOCH;
+
+    if (labs (days) >= MT_MAX_DAYS)
+        return M_INVALID_RANGE_ERR;
+    *t = (int64_t) days * MT_NS_PER_DAY + llround (jd->frac * MT_NS_PER_DAY);
+    return M_NO_ERR;
+}
+
+/**
+ * @brief Convert a timestamp to a julian day
+ *
+ * @param[in] t timestamp
+ *
+ * @return julian day
+ */
+double
+mt_to_jd (m_time_t t)
+{
+    struct dt_jd2_s jd;
+
+    mt_to_jd2 (t, &jd);
+    return jd.day + jd.frac;
+}
+
+/**
+ * @brief Split a timestamp into a two-part julian day
+ *
+ * The integer part is exact, the fraction is exact to the double precision.
+ *
+ * @param[in] t timestamp
+ * @param[out] jd two-part julian day, 0 <= jd->frac < 1
+ */
+void
+mt_to_jd2 (m_time_t t, struct dt_jd2_s *jd)
+{
+    int64_t days = t / MT_NS_PER_DAY;
+    int64_t ns = t % MT_NS_PER_DAY;
+
+    if (ns < 0) {
+        ns += MT_NS_PER_DAY;
+        days--;
+    }
+    jd->day = (long) MT_JD_EPOCH + days;
+    jd->frac = (double) ns / MT_NS_PER_DAY;
+}
+
+/**
+ * @brief Get the date corresponding to a timestamp
+ *
+ * Calendar date from dt_jd_to_date(), time of the day from integer arithmetic.
+ *
+ * @param[in] t timestamp
+ * @param[out] date
+ *
+ * @return error status of the function
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+mt_to_date (m_time_t t, struct tm *date)
+{
+    /* shift by half a day so that days start at 0h */
+    m_time_t t0 = t + MT_NS_PER_DAY / 2;
+    int64_t days = t0 / MT_NS_PER_DAY;
+    int64_t ns = t0 % MT_NS_PER_DAY;
+    m_err_t err;
+
+    if (ns < 0) {
+        ns += MT_NS_PER_DAY;
+        days--;
+    }
+    err = dt_jd_to_date (MT_JD_EPOCH - 0.5 + days, date);
+    if (err)
+        return err;
+    int secs = (int) (ns / 1000000000);
+    date->tm_hour = secs / 3600;
+    date->tm_min = (secs % 3600) / 60;
+    date->tm_sec = secs % 60;
+    return M_NO_ERR;
+}
+
+/**
+ * @brief Get the timestamp of the current date (UTC)
+ *
+ * @param[out] t timestamp
+ *
+ * @return error status of the function
+ * @retval M_IO_ERR the system clock could not be read
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+mt_get_current_time (m_time_t *t)
+{
+    struct timespec ts;
+
+    if (clock_gettime (CLOCK_REALTIME, &ts))
+        return M_IO_ERR;
+    *t = ((int64_t) ts.tv_sec - MT_UNIX_J2000) * 1000000000LL + ts.tv_nsec;
+    return M_NO_ERR;
+}
+
+/**
+ * @brief Convert a timestamp (UT) to a timestamp (Dynamical Time)
+ *
+ * @param[in] t timestamp (Universal Time)
+ *
+ * @return timestamp (Dynamical Time)
+ *
+ * @see dy_ut_to_dt ()
+ */
+m_time_t
+mt_ut_to_dt (m_time_t t)
+{
+    return t + llround (dy_get_deltaT_seconds (mt_to_jd (t)) * 1e9);
+}
+
+/**
+ * @brief Convert a timestamp (Dynamical Time) to a timestamp (UT)
+ *
+ * @param[in] t timestamp (Dynamical Time)
+ *
+ * @return timestamp (Universal Time)
+ *
+ * @see dy_dt_to_ut ()
+ */
+m_time_t
+mt_dt_to_ut (m_time_t t)
+{
+    return t - llround (dy_get_deltaT_seconds (mt_to_jd (t)) * 1e9);
+}
@@ -0,0 +1,125 @@
+/**
+ * @file parallax.c
+ * Meeus chapters 11 and 40. Earth's figure and topocentric coordinates.
+ *
+ * The observer dependent quantities (rho sin phi' and rho cos phi') are
+ * computed once per site by plx_site_init () and then applied to any number
+ * of bodies and times.
+ */
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include "meeus.h"
+
+/* equatorial radius of the Earth, in meters */
+#define PLX_EQU_RADIUS 6378140.0
+/* flattening of the Earth */
+#define PLX_FLATTENING (1 / 298.257)
+/* equatorial horizontal parallax of the Sun at 1 AU, in degrees */
+#define PLX_SOLAR_PARALLAX arcsec_to_deg (8.794)
+/* number of bodies processed at once by the batch kernel */
+#define PLX_BLOCK 256
+
+/**
+ * @brief   Compute the geocentric position of an observer
+ *
+ * Implements Meeus chapter 11 (formulas of page 82).
+ *
+ * @param[in] phi geographical latitude of the observer, in degrees
+ * @param[in] height height of the observer above sea level, in meters
+ * @param[out] site observer constants
+ */
+void
+plx_site_init (double phi, double height, struct plx_site_s *site)
+{
+    double sp, cp, su, cu;
+    double b_a = 1 - PLX_FLATTENING;
+
+    m_sincosd (phi, &sp, &cp);
+    m_sincosd (m_atan2d (b_a * sp, cp), &su, &cu);
+    site->rho_sin = b_a * su + height / PLX_EQU_RADIUS * sp;
+    site->rho_cos = cu + height / PLX_EQU_RADIUS * cp;
+    site->phi1 = m_atan2d (site->rho_sin, site->rho_cos);
+}
+
+/**
+ * @brief   Convert geocentric to topocentric equatorial coordinates
+ *
+ * Implements Meeus formulas 40.1, 40.2 and 40.3.
+ * The topocentric hour angle is H - (*alpha_t - alpha).
+ *
+ * @param[in] site observer constants, from plx_site_init ()
+ * @param[in] H geocentric local hour angle of the body, measured westward from south
+ * @param[in] alpha geocentric right ascension of the body
+ * @param[in] delta geocentric declination of the body
+ * @param[in] dist distance of the body to the Earth, in AU
+ * @param[out] alpha_t topocentric right ascension of the body
+ * @param[out] delta_t topocentric declination of the body
+ *
+ * All angles are in degrees.
+ */
+void
+plx_equ_to_topo (const struct plx_site_s *site, double H, double alpha,
+                 double delta, double dist, double *alpha_t, double *delta_t)
+{
+    double sH, cH, sd, cd;
+    double sin_pi = m_sind (PLX_SOLAR_PARALLAX) / dist;
+
+    m_sincosd (H, &sH, &cH);
+    m_sincosd (delta, &sd, &cd);
+    double x = cd - site->rho_cos * sin_pi * cH;
+    double dalpha = m_atan2d (-site->rho_cos * sin_pi * sH, x);
+    *alpha_t = alpha + dalpha;
+    *delta_t = m_atan2d ((sd - site->rho_sin * sin_pi) * m_cosd (dalpha), x);
+}
+
+/**
+ * @brief   Convert arrays of geocentric to topocentric equatorial coordinates
+ *
+ * Batch version of plx_equ_to_topo (), for bodies or times seen from the
+ * same site. cos (delta alpha) is taken from the arguments of its arc
+ * tangent, so that each element costs two sine/cosine pairs and two arc
+ * tangents, in vectorized blocks.
+ *
+ * @param[in] site observer constants, from plx_site_init ()
+ * @param[in] H geocentric local hour angles, measured westward from south
+ * @param[in] alpha geocentric right ascensions
+ * @param[in] delta geocentric declinations
+ * @param[in] dist distances to the Earth, in AU
+ * @param[in] n number of elements
+ * @param[out] alpha_t topocentric right ascensions
+ * @param[out] delta_t topocentric declinations
+ *
+ * All angles are in degrees.
+ */
+void
+plx_equ_to_topo_batch (const struct plx_site_s *site, const double *H,
+                       const double *alpha, const double *delta,
+                       const double *dist, size_t n, double *alpha_t,
+                       double *delta_t)
+{
+    double sH[PLX_BLOCK], cH[PLX_BLOCK], sd[PLX_BLOCK], cd[PLX_BLOCK];
+    double y[PLX_BLOCK], x[PLX_BLOCK], da[PLX_BLOCK];
+    double sin_pi0 = m_sind (PLX_SOLAR_PARALLAX);
+
+    for (size_t i0 = 0; i0 < n; i0 += PLX_BLOCK) {
+        size_t m = n - i0 < PLX_BLOCK ? n - i0 : PLX_BLOCK;
+        m_sincosd_batch (H + i0, m, sH, cH);
+        m_sincosd_batch (delta + i0, m, sd, cd);
+        for (size_t i = 0; i < m; i++) {
+            double sin_pi = sin_pi0 / dist[i0 + i];
+            y[i] = -site->rho_cos * sin_pi * sH[i];
+            x[i] = cd[i] - site->rho_cos * sin_pi * cH[i];
+        }
+        m_atan2d_batch (y, x, m, da);
+        for (size_t i = 0; i < m; i++) {
+            double sin_pi = sin_pi0 / dist[i0 + i];
+            double r = sqrt (x[i] * x[i] + y[i] * y[i]);
+            alpha_t[i0 + i] = alpha[i0 + i] + da[i];
+            /* (sin delta - rho sin phi' sin pi) cos (delta alpha), over r */
+            y[i] = (sd[i] - site->rho_sin * sin_pi) * x[i];
+            x[i] *= r;
+        }
+        m_atan2d_batch (y, x, m, delta_t + i0);
+    }
+}
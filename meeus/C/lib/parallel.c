@@ -0,0 +1,105 @@
+/**
+ * @file parallel.c
+ * Parallel loops.
+ *
+ * Minimal parallel for loop over an index range, on POSIX threads.
+ * Workers take chunks of the range from a shared atomic counter, so that
+ * uneven chunks balance themselves. The calling thread works too.
+ * Threads are created for each loop: loops are expected to last much
+ * longer than a thread creation (tens of microseconds).
+ */
+#include <stdio.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+#include "meeus.h"
+
+/* maximum number of threads of a loop */
+#define THR_MAX_THREADS 256
+
+/**
+ * @brief shared state of a loop
+ */
+struct thr_loop_s
+{
+    size_t n;
+    size_t grain;
+    thr_fn_t fn;
+    void *ctx;
+    atomic_size_t next;
+};
+
+/**
+ * @brief worker: run chunks until the range is exhausted
+ *
+ * @param[in] arg loop state
+ *
+ * @return NULL
+ */
+static void *
+thr_worker (void *arg)
+{
+    struct thr_loop_s *loop = arg;
+
+    for (;;) {
+        size_t begin = atomic_fetch_add (&loop->next, loop->grain);
+        if (begin >= loop->n)
+            break;
+        size_t end = loop->n - begin < loop->grain ? loop->n : begin +
+            loop->grain;
+        loop->fn (begin, end, loop->ctx);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Get the number of online processors
+ *
+ * @return number of processors, at least 1
+ */
+int
+thr_get_nprocs (void)
+{
+    long n = sysconf (_SC_NPROCESSORS_ONLN);
+    return n < 1 ? 1 : n > THR_MAX_THREADS ? THR_MAX_THREADS : (int) n;
+}
+
+/**
+ * @brief Run a function over an index range, in parallel
+ *
+ * fn (begin, end, ctx) is called on disjoint chunks [begin, end) covering
+ * [0, n), in no particular order and from several threads at once.
+ * If threads cannot be created, the remaining work runs in the calling thread.
+ *
+ * @param[in] n size of the range
+ * @param[in] grain size of the chunks. 0 to split the range evenly between threads.
+ * @param[in] nthreads number of threads. 0 or less to use all processors.
+ * @param[in] fn function processing a chunk
+ * @param[in] ctx context passed to fn
+ */
+void
+thr_for (size_t n, size_t grain, int nthreads, thr_fn_t fn, void *ctx)
+{
+    pthread_t tid[THR_MAX_THREADS];
+    struct thr_loop_s loop = { n, grain, fn, ctx, 0 };
+    int started = 0;
+
+    if (n == 0)
+        return;
+    if (nthreads <= 0)
+        nthreads = thr_get_nprocs ();
+    if (nthreads > THR_MAX_THREADS)
+        nthreads = THR_MAX_THREADS;
+    if (loop.grain == 0)
+        loop.grain = (n + nthreads - 1) / nthreads;
+    if ((size_t) nthreads > (n + loop.grain - 1) / loop.grain)
+        nthreads = (n + loop.grain - 1) / loop.grain;
+
+    for (; started < nthreads - 1; started++)
+        if (pthread_create (&tid[started], NULL, thr_worker, &loop))
+            break;
+    thr_worker (&loop);
+    for (int i = 0; i < started; i++)
+        pthread_join (tid[i], NULL);
+}
@@ -0,0 +1,123 @@
+/**
+ * @file raster.c
+ * Solar altitude and azimuth over geographic grids.
+ *
+ * Same result as sun_apparent_equatorial_coord (), coo_get_local_hour_angle ()
+ * and coo_equ_to_hor () called for each point of the grid, but the Sun and
+ * the sidereal time are computed once, the hour angle terms once per column
+ * and the latitude terms once per row. Each point then costs a few
+ * multiplications and an arc sine / arc tangent, in vectorized batches.
+ * Rows are shared between threads.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+#include "meeus.h"
+
+/* number of points processed at once by the row kernel */
+#define RAS_BLOCK 256
+
+/**
+ * @brief context of the row kernel
+ */
+struct ras_ctx_s
+{
+    const struct ras_grid_s *grid;
+    const double *a;            /* cos (delta) cos (H), per column */
+    const double *b;            /* cos (delta) sin (H), per column */
+    double sd;                  /* sin (delta) */
+    double *A;
+    double *h;
+};
+
+/**
+ * @brief fill the rows [begin, end) of the rasters
+ *
+ * @param[in] begin first row
+ * @param[in] end last row + 1
+ * @param[in] arg context
+ */
+static void
+ras_rows (size_t begin, size_t end, void *arg)
+{
+    const struct ras_ctx_s *ctx = arg;
+    const size_t nlon = ctx->grid->nlon;
+    double x[RAS_BLOCK], z[RAS_BLOCK];
+
+    for (size_t i = begin; i < end; i++) {
+        double sp, cp;
+        m_sincosd (ctx->grid->lat0 + i * ctx->grid->dlat, &sp, &cp);
+        for (size_t j0 = 0; j0 < nlon; j0 += RAS_BLOCK) {
+            size_t m = nlon - j0 < RAS_BLOCK ? nlon - j0 : RAS_BLOCK;
+            const double *a = ctx->a + j0;
+            for (size_t j = 0; j < m; j++) {
+                x[j] = sp * a[j] - cp * ctx->sd;
+                z[j] = cp * a[j] + sp * ctx->sd;
+            }
+            if (ctx->h)
+                m_asind_batch (z, m, ctx->h + i * nlon + j0);
+            if (ctx->A)
+                m_atan2d_batch (ctx->b + j0, x, m, ctx->A + i * nlon + j0);
+        }
+    }
+}
+
+/**
+ * @brief Get the horizontal coordinates of the Sun over a grid
+ *
+ * Point (i, j) of the grid is at latitude grid->lat0 + i * grid->dlat and
+ * longitude grid->lon0 + j * grid->dlon. Rasters are stored row by row:
+ * point (i, j) is at index i * grid->nlon + j.
+ * Altitudes are geometric (not corrected for refraction).
+ *
+ * @param[in] grid grid definition. Longitudes are negative towards east.
+ * @param[in] jd the (UT) julian day
+ * @param[in] accuracy accuracy of the Sun coordinates
+ * @param[in] nthreads number of threads. 0 to use all processors.
+ * @param[out] A azimuths, measured westward from south, between -180 and 180 degrees. Can be NULL.
+ * @param[out] h altitudes, in degrees. Can be NULL.
+ *
+ * @return error status of the function
+ * @retval M_INVALID_RANGE_ERR the grid is empty or jd is out of range
+ * @retval M_NO_MEM_ERR memory allocation failure
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+ras_sun_hor (const struct ras_grid_s *grid, double jd, m_acc_t accuracy,
+             int nthreads, double *A, double *h)
+{
+    double alpha, delta, sid_t, sd, cd;
+    m_err_t err;
+
+    if (grid->nlat == 0 || grid->nlon == 0)
+        return M_INVALID_RANGE_ERR;
+    err = sun_apparent_equatorial_coord (dy_ut_to_dt (jd), &alpha, &delta,
+                                         accuracy);
+    if (err)
+        return err;
+    err = sid_get_apparent_gw_sid_time (jd, &sid_t);
+    if (err)
+        return err;
+
+    double *buf = malloc (3 * grid->nlon * sizeof *buf);
+    if (!buf)
+        return M_NO_MEM_ERR;
+    double *H = buf, *a = buf + grid->nlon, *b = buf + 2 * grid->nlon;
+
+    /* hour angles, then a = cos (delta) cos (H), b = cos (delta) sin (H) */
+    double theta = s_to_deg (sid_t) - alpha;
+    for (size_t j = 0; j < grid->nlon; j++)
+        H[j] = theta - (grid->lon0 + j * grid->dlon);
+    m_sincosd_batch (H, grid->nlon, b, a);
+    m_sincosd (delta, &sd, &cd);
+    for (size_t j = 0; j < grid->nlon; j++) {
+        a[j] *= cd;
+        b[j] *= cd;
+    }
+
+    struct ras_ctx_s ctx = { grid, a, b, sd, A, h };
+    thr_for (grid->nlat, 1, nthreads, ras_rows, &ctx);
+    free (buf);
+    return M_NO_ERR;
+}
@@ -24,7 +24,7 @@ double
 ref_refraction_true_to_apparent (double h, int corrected)
 {
     /* Meeus 16.4 */
-    double R = 1.02 / (tand (h + 10.3 / (h + 5.11)));
+    double R = 1.02 / (m_tand (h + 10.3 / (h + 5.11)));
     if (corrected)              /* corrected so that refraction is 0 at zenith */
         return R + 0.0019279;
     return R;
@@ -46,14 +46,219 @@ ref_refraction_true_to_apparent (double h, int corrected)
 ref_refraction_apparent_to_true (double h0, int corrected)
 {
     /* Meeus 16.3 */
-    double R = 1.0 / (tand (h0 + 7.31 / (h0 + 4.4)));
+    double R = 1.0 / (m_tand (h0 + 7.31 / (h0 + 4.4)));
     if (corrected)              /* corrected so that refraction is 0 at zenith */
         return R + 0.0013515;
     return R;
 #if 0
     /* Bennet's correction to 16.3 - still not correct for zenith */
-    double R = 1.0 / (tand (h0 + 7.31 / (h0 + 4.4)));
-    R -= -0.06 * sind (14.7 * R / 60.0 + 13);
+    double R = 1.0 / (m_tand (h0 + 7.31 / (h0 + 4.4)));
+    R -= -0.06 * m_sind (14.7 * R / 60.0 + 13);
     return R;
 #endif
 }
+
+/* number of altitudes processed at once by the batch functions */
+#define REF_BLOCK 256
+/* maximum number of Newton iterations to invert Meeus 16.4 */
+#define REF_NEWTON_MAX 8
+
+/**
+ * @brief factor of the refraction for a given atmosphere
+ *
+ * Meeus chapter 16: Meeus 16.3 and 16.4 assume a pressure of 1010 millibars
+ * and a temperature of 10 Celsius.
+ *
+ * @param[in] P pressure, in millibars
+ * @param[in] T temperature, in Celsius
+ *
+ * @return multiplier of the refraction
+ */
+static double
+ref_factor (double P, double T)
+{
+    return P / REF_STD_PRESSURE * (273 + REF_STD_TEMPERATURE) / (273 + T);
+}
+
+/**
+ * @brief refraction from airless, for a given atmosphere
+ *
+ * ref_refraction_true_to_apparent () (corrected) multiplied by the pressure
+ * and temperature factor of Meeus chapter 16.
+ *
+ * @param[in] h true altitude in degrees
+ * @param[in] P pressure, in millibars
+ * @param[in] T temperature, in Celsius
+ *
+ * @return refraction in minutes of arc.
+ */
+double
+ref_refraction_true_to_apparent_pt (double h, double P, double T)
+{
+    return ref_factor (P, T) * ref_refraction_true_to_apparent (h, 1);
+}
+
+/**
+ * @brief refraction from measured, for a given atmosphere
+ *
+ * ref_refraction_apparent_to_true () (corrected) multiplied by the pressure
+ * and temperature factor of Meeus chapter 16. Meeus 16.3 is not the exact
+ * inverse of Meeus 16.4 (up to 1' near the horizon): use
+ * ref_table_apparent_to_true () for an exact inverse.
+ *
+ * @param[in] h0 apparent altitude in degrees
+ * @param[in] P pressure, in millibars
+ * @param[in] T temperature, in Celsius
+ *
+ * @return refraction in minutes of arc.
+ */
+double
+ref_refraction_apparent_to_true_pt (double h0, double P, double T)
+{
+    return ref_factor (P, T) * ref_refraction_apparent_to_true (h0, 1);
+}
+
+/**
+ * @brief   Kernel of the batch functions
+ *
+ * Computes R = f (k / tan (x + a / (x + b)) + c), which is Meeus 16.4
+ * (k = 1.02, a = 10.3, b = 5.11) and Meeus 16.3 (k = 1, a = 7.31, b = 4.4),
+ * corrected to be 0 at zenith, with f the atmosphere factor.
+ */
+static void
+ref_batch (const double *restrict x, const double *P, const double *T,
+           size_t n, double k, double a, double b, double c,
+           double *restrict R)
+{
+    double u[REF_BLOCK], s[REF_BLOCK], co[REF_BLOCK];
+
+    for (size_t i0 = 0; i0 < n; i0 += REF_BLOCK) {
+        size_t m = n - i0 < REF_BLOCK ? n - i0 : REF_BLOCK;
+        for (size_t i = 0; i < m; i++)
+            u[i] = x[i0 + i] + a / (x[i0 + i] + b);
+        m_sincosd_batch (u, m, s, co);
+        for (size_t i = 0; i < m; i++)
+            R[i0 + i] = k * co[i] / s[i] + c;
+        if (P || T)
+            for (size_t i = i0; i < i0 + m; i++)
+                R[i] *= ref_factor (P ? P[i] : REF_STD_PRESSURE,
+                                    T ? T[i] : REF_STD_TEMPERATURE);
+    }
+}
+
+/**
+ * @brief refraction from airless, for arrays of altitudes
+ *
+ * Batch version of ref_refraction_true_to_apparent_pt ().
+ *
+ * @param[in] h true altitudes in degrees
+ * @param[in] P pressures, in millibars. Can be NULL for 1010 millibars.
+ * @param[in] T temperatures, in Celsius. Can be NULL for 10 Celsius.
+ * @param[in] n number of altitudes
+ * @param[out] R refractions in minutes of arc.
+ */
+void
+ref_refraction_true_to_apparent_batch (const double *h, const double *P,
+                                       const double *T, size_t n, double *R)
+{
+    ref_batch (h, P, T, n, 1.02, 10.3, 5.11, 0.0019279, R);
+}
+
+/**
+ * @brief refraction from measured, for arrays of altitudes
+ *
+ * Batch version of ref_refraction_apparent_to_true_pt ().
+ *
+ * @param[in] h0 apparent altitudes in degrees
+ * @param[in] P pressures, in millibars. Can be NULL for 1010 millibars.
+ * @param[in] T temperatures, in Celsius. Can be NULL for 10 Celsius.
+ * @param[in] n number of altitudes
+ * @param[out] R refractions in minutes of arc.
+ */
+void
+ref_refraction_apparent_to_true_batch (const double *h0, const double *P,
+                                       const double *T, size_t n, double *R)
+{
+    ref_batch (h0, P, T, n, 1, 7.31, 4.4, 0.0013515, R);
+}
+
+/**
+ * @brief Build the refraction tables of an atmosphere
+ *
+ * Tabulates Meeus 16.4 (corrected, with the pressure and temperature factor)
+ * against the true altitude, and its exact inverse against the apparent
+ * altitude, solved by Newton iterations. Both are interpolated with cubics:
+ * the interpolation costs less than 0.01".
+ *
+ * @param[in] P pressure, in millibars
+ * @param[in] T temperature, in Celsius
+ * @param[out] table refraction tables
+ */
+void
+ref_table_init (double P, double T, struct ref_table_s *table)
+{
+    double f = ref_factor (P, T);
+
+    for (int i = 0; i < REF_TABLE_N; i++) {
+        double x = REF_TABLE_MIN + (i - 1) * REF_TABLE_STEP;
+        table->R[i] = f * ref_refraction_true_to_apparent (x, 1);
+        /* solve h + R (h) / 60 = x, starting from Meeus 16.3 */
+        double h = x - f * ref_refraction_apparent_to_true (x, 1) / 60;
+        for (int k = 0; k < REF_NEWTON_MAX; k++) {
+            double b = h + 5.11, u = h + 10.3 / b, s = m_sind (u);
+            /* derivative of Meeus 16.4, minutes per degree */
+            double dR = -1.02 / (s * s) * deg_to_rad (1 - 10.3 / (b * b));
+            double dh = (h + f * ref_refraction_true_to_apparent (h, 1) / 60
+                         - x) / (1 + f * dR / 60);
+            h -= dh;
+            if (fabs (dh) < 1e-12)
+                break;
+        }
+        table->R0[i] = (x - h) * 60;
+    }
+}
+
+/**
+ * @brief interpolate a refraction table
+ */
+static double
+ref_table_interp (const double *R, double x)
+{
+    double t = (fmin (fmax (x, REF_TABLE_MIN), 90) - REF_TABLE_MIN)
+        / REF_TABLE_STEP;
+    int k = (int) t;
+
+    /* nodes k - 1 .. k + 2, stored from index k: at 90 degrees, the last
+       node is 90 + 2 steps */
+    return interp4 (R + k + 1, t - k);
+}
+
+/**
+ * @brief refraction from airless, from the tables of an atmosphere
+ *
+ * @param[in] table refraction tables, from ref_table_init ()
+ * @param[in] h true altitude in degrees. Clamped to the range of the tables.
+ *
+ * @return refraction in minutes of arc.
+ */
+double
+ref_table_true_to_apparent (const struct ref_table_s *table, double h)
+{
+    return ref_table_interp (table->R, h);
+}
+
+/**
+ * @brief refraction from measured, from the tables of an atmosphere
+ *
+ * Exact inverse of ref_table_true_to_apparent (), without iteration.
+ *
+ * @param[in] table refraction tables, from ref_table_init ()
+ * @param[in] h0 apparent altitude in degrees. Clamped to the range of the tables.
+ *
+ * @return refraction in minutes of arc.
+ */
+double
+ref_table_apparent_to_true (const struct ref_table_s *table, double h0)
+{
+    return ref_table_interp (table->R0, h0);
+}
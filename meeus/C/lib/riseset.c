@@ -0,0 +1,335 @@
+/**
+ * @file riseset.c
+ * Meeus chapter 15. Rising, transit and setting of the Sun, and twilights.
+ *
+ * The Sun is computed at 0h TD of the days D-1, D, D+1 and D+2 and
+ * interpolated (Meeus 3.3) on the three days closest to each instant, so
+ * that events up to one day before or after day D can be refined. The
+ * window slides from day to day with one new Sun position per day, shared by
+ * all observers and all altitudes.
+ *
+ * The approximate times of Meeus 15.2 are computed for the previous, the
+ * current and the next day (m - 1, m, m + 1), refined by Newton iterations
+ * and kept if they fall in day D: events close to 0h UT are neither lost
+ * nor reported twice, and a day can have zero or two events of a kind.
+ * Approximate times far from day D are skipped, so that a day usually costs
+ * one refinement per event.
+ */
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include "meeus.h"
+
+/* maximum number of Newton iterations */
+#define RST_MAX_ITER 20
+/* last correction of the iterations, in days. The Sun moves in hour angle
+   about 365 times slower than the stars, so that the error left is about
+   1e-7 day (0.01 second) */
+#define RST_EPS 1e-5
+/* distinct events are further apart than this, in days */
+#define RST_SAME 1e-5
+/* approximate times further than this from day D are not refined, in days */
+#define RST_MARGIN 0.1
+
+/**
+ * @brief compute the Sun at 0h TD of a day
+ *
+ * @param[in,out] e ephemeris
+ * @param[in] k index of the day in the window (0 for D-1)
+ *
+ * @return error status of sun_apparent_equatorial_coord ()
+ */
+static m_err_t
+rst_sun_sample (struct rst_ephem_s *e, int k)
+{
+    m_err_t err = sun_apparent_equatorial_coord (e->jd - 1 + k, &e->alpha[k],
+                                                 &e->delta[k], e->accuracy);
+    m_sincosd (e->delta[k], &e->sd[k], &e->cd[k]);
+    /* no jump of 360 degrees between samples */
+    if (k > 0)
+        e->alpha[k] = e->alpha[k - 1] + remainder (e->alpha[k] -
+                                                   e->alpha[k - 1], 360);
+    return err;
+}
+
+/**
+ * @brief set the quantities of day D that do not depend on the Sun
+ *
+ * @param[in,out] e ephemeris
+ *
+ * @return error status of sid_get_apparent_gw_sid_time ()
+ */
+static m_err_t
+rst_day_init (struct rst_ephem_s *e)
+{
+    double sid_t;
+    m_err_t err = sid_get_apparent_gw_sid_time (e->jd, &sid_t);
+
+    e->theta0 = s_to_deg (sid_t);
+    e->dt = dy_ut_to_dt (e->jd) - e->jd;
+    return err;
+}
+
+/**
+ * @brief Compute the Sun ephemeris around a day
+ *
+ * @param[in] jd any (UT) julian day of day D
+ * @param[in] accuracy accuracy of the Sun coordinates
+ * @param[out] e ephemeris of day D
+ *
+ * @return error status of the function
+ * @retval M_INVALID_RANGE_ERR jd is out of range
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+rst_sun_ephem_init (double jd, m_acc_t accuracy, struct rst_ephem_s *e)
+{
+    m_err_t err;
+
+    e->jd = floor (jd - 0.5) + 0.5;
+    e->accuracy = accuracy;
+    err = rst_day_init (e);
+    for (int k = 0; k < 4 && !err; k++)
+        err = rst_sun_sample (e, k);
+    return err;
+}
+
+/**
+ * @brief Move the Sun ephemeris to the next day
+ *
+ * Costs one Sun position.
+ *
+ * @param[in,out] e ephemeris of day D, then of day D+1
+ *
+ * @return error status of the function
+ * @retval M_INVALID_RANGE_ERR the day is out of range
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+rst_sun_ephem_next (struct rst_ephem_s *e)
+{
+    m_err_t err;
+
+    for (int k = 0; k < 3; k++) {
+        e->alpha[k] = e->alpha[k + 1];
+        e->delta[k] = e->delta[k + 1];
+        e->sd[k] = e->sd[k + 1];
+        e->cd[k] = e->cd[k + 1];
+    }
+    e->jd += 1;
+    err = rst_day_init (e);
+    return err ? err : rst_sun_sample (e, 3);
+}
+
+/**
+ * @brief interpolate three values
+ *
+ * Implements Meeus formula 3.3.
+ *
+ * @param[in] y values at -1, 0 and 1, given by a pointer to the middle one
+ * @param[in] x interpolating factor
+ *
+ * @return interpolated value
+ */
+static double
+rst_interp3 (const double *y, double x)
+{
+    double a = y[0] - y[-1], b = y[1] - y[0];
+
+    return y[0] + x / 2 * (a + b + x * (b - a));
+}
+
+/**
+ * @brief local hour angle and declination of the Sun at a given time
+ *
+ * The Sun is interpolated on the three samples closest to the time. The
+ * sine and cosine of the declination are interpolated rather than
+ * computed.
+ *
+ * @param[in] e ephemeris
+ * @param[in] L observer longitude, negative towards east
+ * @param[in] m time since 0h UT of day D, in days
+ * @param[out] H local hour angle, between -180 and 180 degrees
+ * @param[out] sd sine of the declination. Can be NULL.
+ * @param[out] cd cosine of the declination. Can be NULL.
+ */
+static void
+rst_hour_angle (const struct rst_ephem_s *e, double L, double m, double *H,
+                double *sd, double *cd)
+{
+    double n = m + e->dt;
+    int c = n < 0.5 ? 1 : 2;
+    double x = n - (c - 1);
+
+    *H = remainder (e->theta0 + 360.985647 * m - L -
+                    rst_interp3 (e->alpha + c, x), 360);
+    if (sd)
+        *sd = rst_interp3 (e->sd + c, x);
+    if (cd)
+        *cd = rst_interp3 (e->cd + c, x);
+}
+
+/**
+ * @brief add an event to a list of at most 2 sorted events
+ *
+ * Events outside day D (or NAN) and events already in the list are ignored.
+ *
+ * @param[in] m time of the event since 0h UT of day D, in days
+ * @param[in,out] list events
+ * @param[in,out] n number of events in the list
+ */
+static void
+rst_add (double m, double *list, int *n)
+{
+    if (!(m >= 0 && m < 1))
+        return;
+    for (int i = 0; i < *n; i++)
+        if (fabs (list[i] - m) < RST_SAME)
+            return;
+    if (*n == 2)
+        return;
+    if (*n == 1 && m < list[0]) {
+        list[1] = list[0];
+        list[0] = m;
+    } else
+        list[*n] = m;
+    (*n)++;
+}
+
+/**
+ * @brief Compute the transits of the Sun over the meridian
+ *
+ * Implements Meeus 15.2 and the correction of the transit time, for the
+ * approximate times m0 - 1, m0 and m0 + 1.
+ *
+ * @param[in] e ephemeris of day D
+ * @param[in] L observer longitude, negative towards east
+ * @param[out] transit (UT) julian days of the transits during day D, sorted. Array of 2.
+ *
+ * @return number of transits during day D: 1, or rarely 0 or 2 when the
+ * transit is close to 0h UT
+ */
+int
+rst_get_transit (const struct rst_ephem_s *e, double L, double *transit)
+{
+    double m0 = rerange ((e->alpha[1] + L - e->theta0) / 360, 1);
+    int n = 0;
+
+    for (int k = -1; k <= 1; k++) {
+        double m = m0 + k, H;
+        if (m < -RST_MARGIN || m >= 1 + RST_MARGIN)
+            continue;
+        for (int i = 0; i < RST_MAX_ITER; i++) {
+            rst_hour_angle (e, L, m, &H, NULL, NULL);
+            m -= H / 360;
+            if (fabs (H / 360) < RST_EPS)
+                break;
+        }
+        rst_add (m, transit, &n);
+    }
+    for (int i = 0; i < n; i++)
+        transit[i] += e->jd;
+    return n;
+}
+
+/**
+ * @brief refine a rising or setting time
+ *
+ * Meeus' correction is applied to sin (h) rather than to h: the root is the
+ * same and no arc sine is needed.
+ *
+ * @param[in] e ephemeris
+ * @param[in] L observer longitude, negative towards east
+ * @param[in] sp sine of the observer latitude
+ * @param[in] cp cosine of the observer latitude
+ * @param[in] sh0 sine of the altitude of the event
+ * @param[in] ch0 cosine of the altitude of the event
+ * @param[in] sign -1 for a rising, 1 for a setting
+ * @param[in] m approximate time since 0h UT of day D, in days
+ *
+ * @return time of the event since 0h UT of day D, or NAN if the iterations
+ * did not converge to an event of the right kind
+ */
+static double
+rst_refine (const struct rst_ephem_s *e, double L, double sp, double cp,
+            double sh0, double ch0, int sign, double m)
+{
+    for (int i = 0; i < RST_MAX_ITER; i++) {
+        double H, sH, cH, sd, cd;
+        rst_hour_angle (e, L, m, &H, &sd, &cd);
+        m_sincosd (H, &sH, &cH);
+        double sh = sp * sd + cp * cd * cH;
+        double dm = (sh - sh0) / (2 * M_PI * ch0 * cd * cp * sH);
+        if (!isfinite (dm) || fabs (dm) > 0.5)
+            return NAN;
+        m += dm;
+        if (fabs (dm) < RST_EPS)
+            return H * sign > 0 ? m : NAN;
+    }
+    return NAN;
+}
+
+/**
+ * @brief Compute the risings and settings of the Sun for several altitudes
+ *
+ * Implements Meeus 15.1 and 15.2 and the corrections of the rising and
+ * setting times, for the approximate times m - 1, m and m + 1. The transit
+ * and the interpolated Sun are shared by all altitudes.
+ * Usual altitudes are RST_SUN_ALT (sunrise and sunset) and RST_CIVIL_ALT,
+ * RST_NAUTICAL_ALT and RST_ASTRONOMICAL_ALT (beginning and end of the
+ * twilights).
+ *
+ * @param[in] e ephemeris of day D
+ * @param[in] L observer longitude, negative towards east
+ * @param[in] phi observer latitude
+ * @param[in] h0 altitudes of the events, in degrees
+ * @param[in] nh number of altitudes
+ * @param[out] ev events during day D, for each altitude
+ */
+void
+rst_get_events (const struct rst_ephem_s *e, double L, double phi,
+                const double *h0, size_t nh, struct rst_event_s *ev)
+{
+    double sp, cp, H, sd, cd;
+    double m0 = (e->alpha[1] + L - e->theta0) / 360;
+
+    m_sincosd (phi, &sp, &cp);
+
+    for (size_t j = 0; j < nh; j++) {
+        struct rst_event_s *v = &ev[j];
+        double sh0, ch0;
+        m_sincosd (h0[j], &sh0, &ch0);
+        /* declination at the beginning and the end of the day */
+        double c0 = (sh0 - sp * e->sd[1]) / (cp * e->cd[1]);
+        double c1 = (sh0 - sp * e->sd[2]) / (cp * e->cd[2]);
+
+        v->n_rise = v->n_set = 0;
+        /* 15.1 on both ends of the day: a crossing may start during the day */
+        if ((c0 <= 1 || c1 <= 1) && (c0 >= -1 || c1 >= -1)) {
+            double c = fmin (fmax (fabs (c0) <= 1 ? c0 : c1, -1), 1);
+            double H0 = rad_to_deg (acos (c)) / 360;
+            double mr = rerange (m0 - H0, 1), ms = rerange (m0 + H0, 1);
+            for (int k = -1; k <= 1; k++) {
+                if (mr + k >= -RST_MARGIN && mr + k < 1 + RST_MARGIN)
+                    rst_add (rst_refine (e, L, sp, cp, sh0, ch0, -1, mr + k),
+                             v->rise, &v->n_rise);
+                if (ms + k >= -RST_MARGIN && ms + k < 1 + RST_MARGIN)
+                    rst_add (rst_refine (e, L, sp, cp, sh0, ch0, 1, ms + k),
+                             v->set, &v->n_set);
+            }
+        }
+        for (int i = 0; i < v->n_rise; i++)
+            v->rise[i] += e->jd;
+        for (int i = 0; i < v->n_set; i++)
+            v->set[i] += e->jd;
+
+        if (v->n_rise || v->n_set)
+            v->state = RST_EVENTS;
+        else {
+            /* no crossing: the whole day is on one side of h0 */
+            rst_hour_angle (e, L, 0.5, &H, &sd, &cd);
+            v->state = sp * sd + cp * cd * m_cosd (H) > sh0 ?
+                RST_ALWAYS_ABOVE : RST_ALWAYS_BELOW;
+        }
+    }
+}
@@ -0,0 +1,311 @@
+/**
+ * @file rotation.c
+ * Coordinate transformations as rotation matrices.
+ *
+ * Equivalent of the coordinates.c transformations (Meeus chapter 13) for
+ * many bodies sharing the same obliquity, observer and time: the matrix is
+ * built once, each body then costs a 3x3 matrix product on its unit vector,
+ * and angles are only computed at the end, if needed.
+ *
+ * Frames are right-handed, with unit vectors built from (longitude, latitude):
+ * - equatorial: x towards the vernal equinox, z towards the north celestial pole (alpha, delta)
+ * - ecliptical: x towards the vernal equinox, z towards the north ecliptic pole (lambda, beta)
+ * - horizontal: x towards the south, y towards the west, z towards the zenith (A, h),
+ *   so that the longitude is the azimuth measured westward from the south, as in Meeus.
+ */
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include "meeus.h"
+
+/**
+ * @brief   Build the ecliptical to equatorial rotation
+ *
+ * @param[in] epsilon obliquity of the ecliptic, in degrees
+ * @param[out] r rotation matrix
+ */
+void
+rot_ecl_to_equ (double epsilon, struct rot_mat_s *r)
+{
+    double se, ce;
+
+    m_sincosd (epsilon, &se, &ce);
+
+    *r = (struct rot_mat_s) { {
+                               {1, 0, 0},
+                               {0, ce, -se},
+                               {0, se, ce}}
+    };
+}
+
+/**
+ * @brief   Build the equatorial to horizontal rotation
+ *
+ * @param[in] theta local sidereal time in degrees (Greenwich sidereal time - L)
+ * @param[in] phi observer latitude in degrees
+ * @param[out] r rotation matrix
+ */
+void
+rot_equ_to_hor (double theta, double phi, struct rot_mat_s *r)
+{
+    double st, ct, sp, cp;
+
+    m_sincosd (theta, &st, &ct);
+    m_sincosd (phi, &sp, &cp);
+
+    /* hour angle frame (H = theta - alpha) then tilt by the colatitude */
+    *r = (struct rot_mat_s) { {
+                               {sp * ct, sp * st, -cp},
+                               {st, -ct, 0},
+                               {cp * ct, cp * st, sp}}
+    };
+}
+
+/**
+ * @brief   Build the equatorial to horizontal rotation for an observer and time
+ *
+ * Greenwich sidereal time is computed once, here.
+ *
+ * @param[in] jd the dynamic (UT) julian day of the observation
+ * @param[in] L longitude of the observer, negative towards east
+ * @param[in] phi observer latitude
+ * @param[in] is_apparent set this parameter to 1 if coordinates are apparent (e.g. affected by nutation)
+ * @param[out] r rotation matrix
+ *
+ * @return return error code
+ * @retval M_NO_ERR The function was successfully executed
+ */
+m_err_t
+rot_get_equ_to_hor (double jd, double L, double phi, int is_apparent,
+                    struct rot_mat_s *r)
+{
+    double sid_t;
+    m_err_t err = is_apparent ? sid_get_apparent_gw_sid_time (jd, &sid_t) :
+        sid_get_mean_gw_sid_time (jd, &sid_t);
+    if (err)
+        return err;
+    rot_equ_to_hor (s_to_deg (sid_t) - L, phi, r);
+    return M_NO_ERR;
+}
+
+/**
+ * @brief   Build the ecliptical to horizontal rotation
+ *
+ * @param[in] epsilon obliquity of the ecliptic, in degrees
+ * @param[in] theta local sidereal time in degrees
+ * @param[in] phi observer latitude in degrees
+ * @param[out] r rotation matrix
+ */
+void
+rot_ecl_to_hor (double epsilon, double theta, double phi,
+                struct rot_mat_s *r)
+{
+    struct rot_mat_s ecl, hor;
+
+    rot_ecl_to_equ (epsilon, &ecl);
+    rot_equ_to_hor (theta, phi, &hor);
+    rot_mul (&hor, &ecl, r);
+}
+
+/**
+ * @brief   Build an elementary rotation of the frame around one of its axes
+ *
+ * @param[in] axis 0, 1 or 2 for x, y or z
+ * @param[in] angle rotation angle in degrees, counterclockwise seen from the tip of the axis
+ * @param[out] r rotation matrix, converting coordinates to the rotated frame
+ */
+static void
+rot_axis (int axis, double angle, struct rot_mat_s *r)
+{
+    double s, c;
+    int i = (axis + 1) % 3, j = (axis + 2) % 3;
+
+    m_sincosd (angle, &s, &c);
+    *r = (struct rot_mat_s) { {
+                               {0, 0, 0},
+                               {0, 0, 0},
+                               {0, 0, 0}}
+    };
+    r->m[axis][axis] = 1;
+    r->m[i][i] = c;
+    r->m[i][j] = s;
+    r->m[j][i] = -s;
+    r->m[j][j] = c;
+}
+
+/**
+ * @brief   Build the precession rotation from J2000.0 to a date
+ *
+ * Implements Meeus formulas 21.3 (with the J2000.0 starting epoch) as the
+ * product R3 (-z) R2 (theta) R3 (-zeta), equivalent to Meeus 21.4.
+ *
+ * @param[in] jde Julian Day Ephemeris (Dynamical time)
+ * @param[out] r rotation from the mean equator and equinox of J2000.0 to the mean equator and equinox of date
+ */
+void
+rot_precession (double jde, struct rot_mat_s *r)
+{
+    double t = get_century_since_j2000 (jde);
+    double zeta = polynom ((const double[]) { 0, 2306.2181, 0.30188,
+                           0.017998
+                           }, t, 3);
+    double z = polynom ((const double[]) { 0, 2306.2181, 1.09468, 0.018203 },
+                        t, 3);
+    double theta = polynom ((const double[]) { 0, 2004.3109, -0.42665,
+                            -0.041833
+                            }, t, 3);
+    struct rot_mat_s a;
+
+    rot_axis (2, -arcsec_to_deg (zeta), r);
+    rot_axis (1, arcsec_to_deg (theta), &a);
+    rot_mul (&a, r, r);
+    rot_axis (2, -arcsec_to_deg (z), &a);
+    rot_mul (&a, r, r);
+}
+
+/**
+ * @brief   Build the nutation rotation at a date
+ *
+ * Rotation R1 (-epsilon) R3 (-delta_psi) R1 (epsilon0), with epsilon0 the
+ * mean and epsilon the true obliquity of the ecliptic (Meeus chapter 22).
+ *
+ * @param[in] jde Julian Day Ephemeris (Dynamical time)
+ * @param[in] accuracy accuracy of the nutation
+ * @param[out] r rotation from the mean to the true equator and equinox of date
+ *
+ * @return return error code
+ * @retval M_INVALID_RANGE_ERR jde out of the validity range of the obliquity
+ * @retval M_NO_ERR The function was successfully executed
+ */
+m_err_t
+rot_nutation (double jde, m_acc_t accuracy, struct rot_mat_s *r)
+{
+    double eps0, delta_psi, delta_eps;
+    struct rot_mat_s a;
+    m_err_t err = ecl_mean_obl_ecliptic (jde, &eps0, accuracy);
+
+    if (err)
+        return err;
+    ecl_nutation (jde, accuracy, &delta_psi, &delta_eps);
+    rot_axis (0, arcsec_to_deg (eps0), r);
+    rot_axis (2, -arcsec_to_deg (delta_psi), &a);
+    rot_mul (&a, r, r);
+    rot_axis (0, -arcsec_to_deg (eps0 + delta_eps), &a);
+    rot_mul (&a, r, r);
+    return M_NO_ERR;
+}
+
+/**
+ * @brief   Compose two rotations
+ *
+ * @param[in] a rotation applied second
+ * @param[in] b rotation applied first
+ * @param[out] r a * b. Can be a or b.
+ */
+void
+rot_mul (const struct rot_mat_s *a, const struct rot_mat_s *b,
+         struct rot_mat_s *r)
+{
+    struct rot_mat_s t;
+
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            t.m[i][j] = a->m[i][0] * b->m[0][j] + a->m[i][1] * b->m[1][j] +
+                a->m[i][2] * b->m[2][j];
+    *r = t;
+}
+
+/**
+ * @brief   Inverse of a rotation
+ *
+ * @param[in] a rotation
+ * @param[out] r inverse (transpose) of a. Can be a.
+ */
+void
+rot_transpose (const struct rot_mat_s *a, struct rot_mat_s *r)
+{
+    struct rot_mat_s t;
+
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            t.m[i][j] = a->m[j][i];
+    *r = t;
+}
+
+/**
+ * @brief   Convert spherical coordinates to unit vectors
+ *
+ * @param[in] lon longitudes in degrees (alpha, lambda or A)
+ * @param[in] lat latitudes in degrees (delta, beta or h)
+ * @param[in] n number of vectors
+ * @param[out] x x components
+ * @param[out] y y components
+ * @param[out] z z components
+ */
+void
+rot_sph_to_vec (const double *restrict lon, const double *restrict lat,
+                size_t n, double *restrict x, double *restrict y,
+                double *restrict z)
+{
+    /* z holds sin (lat) and y cos (lat) until the second pass */
+    m_sincosd_batch (lat, n, z, y);
+    for (size_t i = 0; i < n; i++) {
+        double sl, cl;
+        m_sincosd (lon[i], &sl, &cl);
+        x[i] = y[i] * cl;
+        y[i] = y[i] * sl;
+    }
+}
+
+/**
+ * @brief   Rotate an array of vectors
+ *
+ * @param[in] r rotation matrix
+ * @param[in] x x components
+ * @param[in] y y components
+ * @param[in] z z components
+ * @param[in] n number of vectors
+ * @param[out] xo rotated x components
+ * @param[out] yo rotated y components
+ * @param[out] zo rotated z components
+ */
+void
+rot_apply (const struct rot_mat_s *r, const double *restrict x,
+           const double *restrict y, const double *restrict z, size_t n,
+           double *restrict xo, double *restrict yo, double *restrict zo)
+{
+    const double m00 = r->m[0][0], m01 = r->m[0][1], m02 = r->m[0][2];
+    const double m10 = r->m[1][0], m11 = r->m[1][1], m12 = r->m[1][2];
+    const double m20 = r->m[2][0], m21 = r->m[2][1], m22 = r->m[2][2];
+
+    for (size_t i = 0; i < n; i++) {
+        xo[i] = m00 * x[i] + m01 * y[i] + m02 * z[i];
+        yo[i] = m10 * x[i] + m11 * y[i] + m12 * z[i];
+        zo[i] = m20 * x[i] + m21 * y[i] + m22 * z[i];
+    }
+}
+
+/**
+ * @brief   Convert vectors to spherical coordinates
+ *
+ * Vectors need not be normalized.
+ *
+ * @param[in] x x components
+ * @param[in] y y components
+ * @param[in] z z components
+ * @param[in] n number of vectors
+ * @param[out] lon longitudes in degrees, between 0 and 360. Can be NULL.
+ * @param[out] lat latitudes in degrees. Can be NULL.
+ */
+void
+rot_vec_to_sph (const double *restrict x, const double *restrict y,
+                const double *restrict z, size_t n, double *restrict lon,
+                double *restrict lat)
+{
+    if (lon)
+        for (size_t i = 0; i < n; i++)
+            lon[i] = rerange (m_atan2d (y[i], x[i]), 360);
+    if (lat)
+        for (size_t i = 0; i < n; i++)
+            lat[i] = m_atan2d (z[i], sqrt (x[i] * x[i] + y[i] * y[i]));
+}
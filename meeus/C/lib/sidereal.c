@@ -83,6 +83,134 @@ sid_get_mean_gw_sid_time (double jd, double *sid_t)
         return sid_get_mean_gw_sid_time_anyut (jd, sid_t);
 }
 
+/**
+ * @brief  Mean sidereal time in degrees for a timestamp
+ *
+ * Meeus 12.4, with the timestamp split exactly into whole days and
+ * fraction of day since J2000.0, and 360.98564736629 * days reduced
+ * modulo 360.
+ *
+ * @param[in] t timestamp (Universal Time).
+ * @param[out] T time in Julian centuries since J2000.0. Can be NULL.
+ *
+ * @return linear part of the mean sidereal time at Greenwich in degrees,
+ * between 0 and 360, without the T^2 and T^3 terms
+ */
+static double
+sid_get_mean_linear_deg_mt (m_time_t t, double *T)
+{
+    int64_t days = t / MT_NS_PER_DAY;
+    int64_t ns = t % MT_NS_PER_DAY;
+
+    if (ns < 0) {
+        ns += MT_NS_PER_DAY;
+        days--;
+    }
+    double f = (double) ns / MT_NS_PER_DAY;
+    if (T)
+        *T = (days + f) / 36525.0;
+    return rerange (280.46061837 + rerange (0.98564736629 * days, 360) +
+                    360.98564736629 * f, 360);
+}
+
+/**
+ * @brief  T^2 and T^3 terms of Meeus 12.4
+ *
+ * @param[in] T time in Julian centuries since J2000.0
+ *
+ * @return correction in degrees
+ */
+static inline double
+sid_get_mean_poly_deg (double T)
+{
+    return 0.000387933 * T * T - T * T * T / 38710000;
+}
+
+/**
+ * @brief  Get mean sidereal time at Greenwich from a timestamp
+ *
+ * Same as sid_get_mean_gw_sid_time (), but the timestamp is split exactly
+ * into whole days and fraction of day since J2000.0. The whole days only
+ * contribute by their excess over full turns, so no precision is lost on
+ * the 360.98564736629 degrees per day rate.
+ *
+ * @param[in] t timestamp (Universal Time).
+ * @param[out] sid_t sidereal time at Greenwich for t.
+ *
+ * @return Error status if the function
+ * @retval M_ERR_OK function ran properly
+ */
+m_err_t
+sid_get_mean_gw_sid_time_mt (m_time_t t, double *sid_t)
+{
+    int64_t days = t / MT_NS_PER_DAY;
+    int64_t ns = t % MT_NS_PER_DAY;
+
+    if (ns < 0) {
+        ns += MT_NS_PER_DAY;
+        days--;
+    }
+    if (ns == MT_NS_PER_DAY / 2)        /* 0h UT */
+        return sid_get_mean_gw_sid_time_0ut (MT_JD_EPOCH + days + 0.5, sid_t);
+
+    double T;
+    double mst = sid_get_mean_linear_deg_mt (t, &T);
+    *sid_t = deg_to_s (rerange (mst + sid_get_mean_poly_deg (T), 360));
+    return M_NO_ERR;
+}
+
+/**
+ * @brief  Equation of the equinoxes
+ *
+ * Nutation in longitude and in obliquity are computed in one pass.
+ *
+ * @param[in] jde Julian Day Ephemeris (Dynamical time)
+ * @param[out] eqeq apparent minus mean sidereal time, in seconds of time
+ *
+ * @return Error status if the function
+ * @retval M_ERR_OK function ran properly
+ */
+static m_err_t
+sid_get_equation_of_equinoxes (double jde, double *eqeq)
+{
+    double epsilon, delta_psi, delta_eps;
+    m_err_t err = ecl_mean_obl_ecliptic (jde, &epsilon, 1);
+
+    if (err)
+        return err;
+    ecl_nutation (jde, 1, &delta_psi, &delta_eps);
+    /* delta_psi is in arcseconds, epsilon is in arcseconds, correction in seconds of time */
+    *eqeq = delta_psi * m_cosd ((epsilon + delta_eps) / 3600) / 15;
+    return M_NO_ERR;
+}
+
+/**
+ * @brief  Get apparent sidereal time at Greenwich from a timestamp
+ *
+ * @param[in] t timestamp (Universal Time).
+ * @param[out] sid_t sidereal time at Greenwich for t.
+ *
+ * @return Error status if the function
+ * @retval M_ERR_OK function ran properly
+ *
+ * @see sid_get_apparent_gw_sid_time ()
+ */
+m_err_t
+sid_get_apparent_gw_sid_time_mt (m_time_t t, double *sid_t)
+{
+    double mean_t, eqeq;
+    m_err_t err;
+
+    err = sid_get_mean_gw_sid_time_mt (t, &mean_t);
+    if (err)
+        return err;
+    err = sid_get_equation_of_equinoxes (mt_to_jd (mt_ut_to_dt (t)), &eqeq);
+    if (err)
+        return err;
+    *sid_t = mean_t + eqeq;
+    return M_NO_ERR;
+}
+
 /**
  * @brief  Get apparent sidereal time at Greenwich
  *
@@ -102,19 +230,109 @@ sid_get_mean_gw_sid_time (double jd, double *sid_t)
 m_err_t
 sid_get_apparent_gw_sid_time (double jd, double *sid_t)
 {
-    double mean_t, err, epsilon;
-    double jde = jd_to_jde (jd);        /* The difference between JD and JDE is probably insignificant here, but still... */
-    double delta_psi = ecl_nut_in_lon (jde, 1); /* nutation in longitude computed from JDE */
+    double mean_t, correction;
+    m_err_t err;
 
     err = sid_get_mean_gw_sid_time (jd, &mean_t);
     if (err)
         return err;
-    err = ecl_true_obl_ecliptic (jde, &epsilon, 1);     /* nutation in obliquity computed from JDE */
+    /* nutation computed from JDE. The difference between JD and JDE is probably insignificant here, but still... */
+    err = sid_get_equation_of_equinoxes (jd_to_jde (jd), &correction);
     if (err)
         return err;
-
-    /* delta_psi is in arcseconds, epsilon is in arcseconds, correction in seconds of time */
-    double correction = delta_psi * cosd (epsilon / 3600) / 15;
     *sid_t = mean_t + correction;
     return M_NO_ERR;
 }
+
+/**
+ * @brief  Set the anchor of a sidereal time stepper
+ *
+ * @param[in,out] st stepper
+ * @param[in] t timestamp (Universal Time) of the anchor
+ *
+ * @return Error status if the function
+ * @retval M_ERR_OK function ran properly
+ */
+static m_err_t
+sid_stepper_anchor (struct sid_stepper_s *st, m_time_t t)
+{
+    st->anchor = t;
+    st->k = 0;
+    st->anchor_mst = sid_get_mean_linear_deg_mt (t, &st->anchor_T);
+    st->eqeq = 0;
+    if (st->is_apparent)
+        return sid_get_equation_of_equinoxes (mt_to_jd (mt_ut_to_dt (t)),
+                                                 &st->eqeq);
+    return M_NO_ERR;
+}
+
+/**
+ * @brief  Initialize a sidereal time stepper
+ *
+ * A stepper returns sidereal time at Greenwich at t0, t0 + step,
+ * t0 + 2 step... for a cost of a few operations per step. Mean sidereal time
+ * is advanced exactly from the last anchor with the rate of Meeus 12.4, using
+ * an integer count of steps, then the small T^2 and T^3 terms are added. The
+ * slow terms (nutation in longitude and true obliquity, for apparent sidereal
+ * time) are only recomputed when a new anchor is set, every refresh interval.
+ * With a refresh interval of one hour, apparent sidereal time is within 1 ms
+ * of time of sid_get_apparent_gw_sid_time_mt ().
+ *
+ * @param[out] st stepper
+ * @param[in] t0 timestamp (Universal Time) of the first step
+ * @param[in] step time between steps, in nanoseconds
+ * @param[in] refresh interval between anchors, in nanoseconds
+ * @param[in] is_apparent set this parameter to 1 to get apparent sidereal time
+ *
+ * @return Error status if the function
+ * @retval M_INVALID_RANGE_ERR step or refresh is not positive
+ * @retval M_ERR_OK function ran properly
+ */
+m_err_t
+sid_stepper_init (struct sid_stepper_s *st, m_time_t t0, m_time_t step,
+                  m_time_t refresh, int is_apparent)
+{
+    if (step <= 0 || refresh <= 0)
+        return M_INVALID_RANGE_ERR;
+    st->step = step;
+    st->refresh = refresh;
+    st->is_apparent = is_apparent;
+    return sid_stepper_anchor (st, t0);
+}
+
+/**
+ * @brief  Get sidereal time at the current step, and move to the next step
+ *
+ * @param[in,out] st stepper
+ * @param[out] t timestamp (Universal Time) of the current step. Can be NULL.
+ * @param[out] sid_t sidereal time at Greenwich at the current step, in
+ * seconds.
+ *
+ * @return Error status if the function
+ * @retval M_ERR_OK function ran properly
+ */
+m_err_t
+sid_stepper_next (struct sid_stepper_s *st, m_time_t *t, double *sid_t)
+{
+    m_time_t elapsed = st->k * st->step;
+    m_err_t err;
+
+    if (elapsed >= st->refresh) {
+        err = sid_stepper_anchor (st, st->anchor + elapsed);
+        if (err)
+            return err;
+        elapsed = 0;
+    }
+    int64_t days = elapsed / MT_NS_PER_DAY;
+    double f = (double) (elapsed % MT_NS_PER_DAY) / MT_NS_PER_DAY;
+    double T = st->anchor_T + (days + f) / 36525.0;
+    double mst = rerange (st->anchor_mst + rerange (0.98564736629 * days, 360)
+                          + 360.98564736629 * f + sid_get_mean_poly_deg (T),
+                          360);
+
+    if (t)
+        *t = st->anchor + elapsed;
+    *sid_t = deg_to_s (mst) + st->eqeq;
+    st->k++;
+    return M_NO_ERR;
+}
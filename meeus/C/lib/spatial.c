@@ -0,0 +1,561 @@
+/**
+ * @file spatial.c
+ * Spatial index of directions on the sphere.
+ *
+ * Sphere-cube quadtree: each direction is projected on the face of the cube
+ * towards which it points, face coordinates are warped by atan () so that
+ * cells have nearly equal areas, and each face is split in 2^SPI_DEPTH x
+ * 2^SPI_DEPTH cells. Points are sorted by face and Morton (Z-order) code of
+ * their cell, so that every node of the quadtree, at every level, is a
+ * contiguous range of the sorted arrays. No node is stored: a query walks
+ * the tree from the 6 faces, finding the range of a node by binary search,
+ * and skips or accepts whole nodes by comparing the query cone with the
+ * bounding cap of the node.
+ *
+ * Cell edges are great circles, so the bounding cap of a cell is given by
+ * its corners. Queries can be made in another frame than the one of the
+ * index (e.g. after precession) by rotating the query instead of the points.
+ * The same way, objects above the horizon of an observer are the points of
+ * the cone around the zenith.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include "meeus.h"
+
+/* depth of the quadtree: 2^20 x 2^20 cells per face, about 0.2 arcsecond */
+#define SPI_DEPTH 20
+/* nodes with at most this number of points are tested point by point */
+#define SPI_LEAF 32
+/* margin on the bounding caps, in radians, for rounding errors */
+#define SPI_EPS 1e-12
+/* number of altitudes computed at once */
+#define SPI_BLOCK 256
+
+/**
+ * @brief point of the index being sorted
+ */
+struct spi_item_s
+{
+    uint64_t key;
+    size_t id;
+};
+
+/**
+ * @brief interleave the bits of i and j (Morton code)
+ *
+ * @param[in] i first coordinate, SPI_DEPTH bits
+ * @param[in] j second coordinate, SPI_DEPTH bits
+ *
+ * @return Morton code, 2 SPI_DEPTH bits
+ */
+static uint64_t
+spi_morton (uint32_t i, uint32_t j)
+{
+    uint64_t r = 0;
+    for (int b = 0; b < SPI_DEPTH; b++)
+        r |= (uint64_t) ((i >> b) & 1) << (2 * b + 1) |
+            (uint64_t) ((j >> b) & 1) << (2 * b);
+    return r;
+}
+
+/**
+ * @brief cell key of a direction
+ *
+ * @param[in] p direction, need not be normalized
+ *
+ * @return face (3 bits) followed by the Morton code of the cell
+ */
+static uint64_t
+spi_key (const double *p)
+{
+    double ax = fabs (p[0]), ay = fabs (p[1]), az = fabs (p[2]);
+    int a = ax >= ay && ax >= az ? 0 : ay >= az ? 1 : 2;
+    int face = a + (p[a] < 0 ? 3 : 0);
+    double m = fabs (p[a]);
+    uint32_t n = 1u << SPI_DEPTH;
+    uint32_t c[2];
+
+    for (int k = 0; k < 2; k++) {
+        double st = atan (p[(a + 1 + k) % 3] / m) * (4 / M_PI);
+        double f = floor ((st + 1) * 0.5 * n);
+        c[k] = f < 0 ? 0 : f >= n ? n - 1 : (uint32_t) f;
+    }
+    return (uint64_t) face << (2 * SPI_DEPTH) | spi_morton (c[0], c[1]);
+}
+
+/**
+ * @brief direction of a point of a face
+ *
+ * @param[in] face cube face (0 to 5)
+ * @param[in] s first warped face coordinate, between -1 and 1
+ * @param[in] t second warped face coordinate, between -1 and 1
+ * @param[out] p unit vector
+ */
+static void
+spi_face_to_vec (int face, double s, double t, double *p)
+{
+    int a = face % 3;
+    double k;
+
+    p[a] = face < 3 ? 1 : -1;
+    p[(a + 1) % 3] = tan (s * M_PI / 4);
+    p[(a + 2) % 3] = tan (t * M_PI / 4);
+    k = 1 / sqrt (p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+    p[0] *= k;
+    p[1] *= k;
+    p[2] *= k;
+}
+
+/**
+ * @brief compare two items by key, for qsort ()
+ */
+static int
+spi_cmp (const void *a, const void *b)
+{
+    uint64_t ka = ((const struct spi_item_s *) a)->key;
+    uint64_t kb = ((const struct spi_item_s *) b)->key;
+    return ka < kb ? -1 : ka > kb;
+}
+
+/**
+ * @brief Build a spatial index
+ *
+ * @param[in] x x components of the directions
+ * @param[in] y y components of the directions
+ * @param[in] z z components of the directions
+ * @param[in] n number of directions
+ * @param[out] idx the index. Release it with spi_free().
+ *
+ * @return error status of the function
+ * @retval M_NO_MEM_ERR memory allocation failed
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+spi_build (const double *x, const double *y, const double *z, size_t n,
+           struct spi_s *idx)
+{
+    struct spi_item_s *items = malloc ((n ? n : 1) * sizeof *items);
+    void *buf = malloc ((n ? n : 1) * (sizeof (uint64_t) + sizeof (size_t) +
+                                       3 * sizeof (double)));
+
+    if (!items || !buf) {
+        free (items);
+        free (buf);
+        return M_NO_MEM_ERR;
+    }
+    for (size_t i = 0; i < n; i++) {
+        items[i].key = spi_key ((const double[]) { x[i], y[i], z[i] });
+        items[i].id = i;
+    }
+    qsort (items, n, sizeof *items, spi_cmp);
+
+    idx->n = n;
+    idx->x = buf;
+    idx->y = idx->x + n;
+    idx->z = idx->y + n;
+    idx->key = (uint64_t *) (idx->z + n);
+    idx->id = (size_t *) (idx->key + n);
+    for (size_t i = 0; i < n; i++) {
+        size_t k = items[i].id;
+        double r = 1 / sqrt (x[k] * x[k] + y[k] * y[k] + z[k] * z[k]);
+        idx->key[i] = items[i].key;
+        idx->id[i] = k;
+        idx->x[i] = x[k] * r;
+        idx->y[i] = y[k] * r;
+        idx->z[i] = z[k] * r;
+    }
+    free (items);
+    return M_NO_ERR;
+}
+
+/**
+ * @brief Build a spatial index of the J2000.0 positions of a catalog
+ *
+ * Identifiers returned by the queries are the star indices in the catalog.
+ *
+ * @param[in] cat catalog
+ * @param[out] idx the index. Release it with spi_free().
+ *
+ * @return error status of the function
+ * @retval M_NO_MEM_ERR memory allocation failed
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+spi_build_cat (const struct cat_s *cat, struct spi_s *idx)
+{
+    return spi_build (cat->x, cat->y, cat->z, cat->count, idx);
+}
+
+/**
+ * @brief Release a spatial index
+ *
+ * @param[in,out] idx the index
+ */
+void
+spi_free (struct spi_s *idx)
+{
+    free (idx->x);
+    idx->x = NULL;
+    idx->n = 0;
+}
+
+/**
+ * @brief first position of the sorted keys not below key
+ */
+static size_t
+spi_lower_bound (const struct spi_s *idx, uint64_t key)
+{
+    size_t lo = 0, hi = idx->n;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (idx->key[mid] < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/**
+ * @brief state of a cone search
+ */
+struct spi_query_s
+{
+    const struct spi_s *idx;
+    double c[3];                /* center, in the index frame */
+    double radius;              /* radius, in radians */
+    double cos_r;
+    spi_fn_t fn;
+    void *ctx;
+    size_t count;
+};
+
+/**
+ * @brief report the points [begin, end) that are in the cone
+ *
+ * @param[in,out] q query
+ * @param[in] begin first point (sorted position)
+ * @param[in] end last point + 1
+ * @param[in] all 1 if the points are known to be in the cone
+ */
+static void
+spi_scan (struct spi_query_s *q, size_t begin, size_t end, int all)
+{
+    const struct spi_s *idx = q->idx;
+
+    for (size_t i = begin; i < end; i++) {
+        double d = q->c[0] * idx->x[i] + q->c[1] * idx->y[i] +
+            q->c[2] * idx->z[i];
+        if (all || d >= q->cos_r) {
+            q->count++;
+            if (q->fn)
+                q->fn (idx->id[i], d, q->ctx);
+        }
+    }
+}
+
+/**
+ * @brief walk a node of the quadtree
+ *
+ * @param[in,out] q query
+ * @param[in] face cube face
+ * @param[in] level level of the node (0 for the face)
+ * @param[in] i first coordinate of the node at its level
+ * @param[in] j second coordinate of the node at its level
+ */
+static void
+spi_walk (struct spi_query_s *q, int face, int level, uint32_t i, uint32_t j)
+{
+    int shift = 2 * (SPI_DEPTH - level);
+    uint64_t base = (uint64_t) face << (2 * SPI_DEPTH) |
+        spi_morton (i, j) << shift;
+    size_t begin = spi_lower_bound (q->idx, base);
+    size_t end = spi_lower_bound (q->idx, base + ((uint64_t) 1 << shift));
+
+    if (begin == end)
+        return;
+    if (end - begin <= SPI_LEAF || level == SPI_DEPTH) {
+        spi_scan (q, begin, end, 0);
+        return;
+    }
+
+    /* bounding cap of the cell */
+    double w = 2.0 / (1u << level);
+    double s0 = i * w - 1, t0 = j * w - 1;
+    double center[3], corner[3], rho = 0;
+    spi_face_to_vec (face, s0 + w / 2, t0 + w / 2, center);
+    for (int k = 0; k < 4; k++) {
+        spi_face_to_vec (face, s0 + (k & 1) * w, t0 + (k >> 1) * w, corner);
+        double d = center[0] * corner[0] + center[1] * corner[1] +
+            center[2] * corner[2];
+        rho = fmax (rho, acos (fmin (d, 1)));
+    }
+    rho += SPI_EPS;
+    double d = center[0] * q->c[0] + center[1] * q->c[1] + center[2] * q->c[2];
+    double sep = acos (fmax (fmin (d, 1), -1));
+
+    if (sep > q->radius + rho)
+        return;
+    if (sep + rho < q->radius - SPI_EPS) {
+        spi_scan (q, begin, end, 1);
+        return;
+    }
+    for (int k = 0; k < 4; k++)
+        spi_walk (q, face, level + 1, 2 * i + (k >> 1), 2 * j + (k & 1));
+}
+
+/**
+ * @brief center of a query in the index frame
+ *
+ * @param[in] r rotation from the index frame to the query frame. Can be NULL.
+ * @param[in] c center in the query frame
+ * @param[out] out normalized center in the index frame
+ */
+static void
+spi_query_center (const struct rot_mat_s *r, const double *c, double *out)
+{
+    double k = 1 / sqrt (c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+
+    for (int i = 0; i < 3; i++)
+        out[i] = r ? (r->m[0][i] * c[0] + r->m[1][i] * c[1] +
+                      r->m[2][i] * c[2]) * k : c[i] * k;
+}
+
+/**
+ * @brief Find the points within a given angular distance of a direction
+ *
+ * fn (id, cos_sep, ctx) is called for each point found, with id its index
+ * in the arrays given to spi_build() and cos_sep the cosine of its
+ * angular separation with the center (Meeus chapter 17), in no particular order.
+ *
+ * @param[in] idx the index
+ * @param[in] r rotation from the index frame to the frame of c (e.g. precession). NULL if they are the same.
+ * @param[in] c direction of the center of the cone, need not be normalized
+ * @param[in] radius radius of the cone, in degrees
+ * @param[in] fn function called for each point found. Can be NULL.
+ * @param[in] ctx context passed to fn
+ *
+ * @return number of points found
+ */
+size_t
+spi_cone (const struct spi_s *idx, const struct rot_mat_s *r, const double *c,
+          double radius, spi_fn_t fn, void *ctx)
+{
+    struct spi_query_s q = {.idx = idx,.radius = deg_to_rad (radius),
+        .cos_r = radius >= 180 ? -2 : m_cosd (radius),.fn = fn,.ctx = ctx
+    };
+
+    spi_query_center (r, c, q.c);
+    for (int face = 0; face < 6; face++)
+        spi_walk (&q, face, 0, 0, 0);
+    return q.count;
+}
+
+/**
+ * @brief candidates of a k-nearest search
+ */
+struct spi_knn_s
+{
+    size_t *id;
+    double *d;
+    size_t n;
+    size_t cap;
+};
+
+static void
+spi_knn_add (size_t id, double cos_sep, void *arg)
+{
+    struct spi_knn_s *k = arg;
+    if (k->n < k->cap) {
+        k->id[k->n] = id;
+        k->d[k->n] = cos_sep;
+    }
+    k->n++;
+}
+
+/**
+ * @brief Find the k nearest points of a direction
+ *
+ * Cone searches of growing radius, starting from the radius that holds
+ * about k points if they are evenly spread.
+ *
+ * @param[in] idx the index
+ * @param[in] r rotation from the index frame to the frame of c. NULL if they are the same.
+ * @param[in] c direction, need not be normalized
+ * @param[in] k number of points to find
+ * @param[out] id indices of the points found, nearest first
+ * @param[out] sep angular separations, in degrees. Can be NULL.
+ *
+ * @return number of points found: k, or the size of the index if smaller
+ * @retval 0 memory allocation failed, or the index is empty
+ */
+size_t
+spi_knn (const struct spi_s *idx, const struct rot_mat_s *r, const double *c,
+         size_t k, size_t *id, double *sep)
+{
+    struct spi_knn_s cand = { NULL, NULL, 0, 0 };
+    double radius;
+
+    if (k > idx->n)
+        k = idx->n;
+    if (k == 0)
+        return 0;
+    radius = rad_to_deg (2 * sqrt ((double) k / idx->n));
+    for (;;) {
+        radius = radius > 180 ? 180 : radius;
+        cand.n = 0;
+        spi_cone (idx, r, c, radius, spi_knn_add, &cand);
+        if (cand.n > cand.cap) {
+            /* buffers too small: grow and search again with the same radius */
+            free (cand.id);
+            free (cand.d);
+            cand.cap = 2 * cand.n;
+            cand.id = malloc (cand.cap * sizeof *cand.id);
+            cand.d = malloc (cand.cap * sizeof *cand.d);
+            if (!cand.id || !cand.d) {
+                free (cand.id);
+                free (cand.d);
+                return 0;
+            }
+            continue;
+        }
+        if (cand.n >= k)
+            break;
+        radius *= 2;
+    }
+
+    /* partial selection sort of the k nearest (largest cosines) */
+    for (size_t i = 0; i < k; i++) {
+        size_t best = i;
+        for (size_t j = i + 1; j < cand.n; j++)
+            if (cand.d[j] > cand.d[best])
+                best = j;
+        double td = cand.d[i];
+        size_t ti = cand.id[i];
+        cand.d[i] = cand.d[best];
+        cand.id[i] = cand.id[best];
+        cand.d[best] = td;
+        cand.id[best] = ti;
+        id[i] = cand.id[i];
+        if (sep)
+            sep[i] = rad_to_deg (acos (fmin (cand.d[i], 1)));
+    }
+    free (cand.id);
+    free (cand.d);
+    return k;
+}
+
+/**
+ * @brief state of a pair search
+ */
+struct spi_pairs_s
+{
+    size_t first;               /* id of the point being searched around */
+    spi_pair_fn_t fn;
+    void *ctx;
+    size_t count;
+};
+
+static void
+spi_pairs_add (size_t id, double cos_sep, void *arg)
+{
+    struct spi_pairs_s *p = arg;
+    if (id <= p->first)
+        return;
+    p->count++;
+    if (p->fn)
+        p->fn (p->first, id, cos_sep, p->ctx);
+}
+
+/**
+ * @brief Find all the pairs of points closer than an angular distance
+ *
+ * fn (i, j, cos_sep, ctx) is called once for each pair, with i < j.
+ *
+ * @param[in] idx the index
+ * @param[in] theta maximum angular separation, in degrees
+ * @param[in] fn function called for each pair. Can be NULL.
+ * @param[in] ctx context passed to fn
+ *
+ * @return number of pairs found
+ */
+size_t
+spi_pairs (const struct spi_s *idx, double theta, spi_pair_fn_t fn,
+           void *ctx)
+{
+    struct spi_pairs_s p = { 0, fn, ctx, 0 };
+
+    for (size_t i = 0; i < idx->n; i++) {
+        p.first = idx->id[i];
+        spi_cone (idx, NULL,
+                  (const double[]) { idx->x[i], idx->y[i], idx->z[i] },
+                  theta, spi_pairs_add, &p);
+    }
+    return p.count;
+}
+
+/**
+ * @brief state of a visibility query
+ */
+struct spi_visible_s
+{
+    size_t *id;
+    double *h;
+    size_t max;
+    size_t n;
+};
+
+static void
+spi_visible_add (size_t id, double cos_sep, void *arg)
+{
+    struct spi_visible_s *v = arg;
+    if (v->n < v->max) {
+        v->id[v->n] = id;
+        v->h[v->n] = cos_sep;
+    }
+    v->n++;
+}
+
+/**
+ * @brief Find the points above a given altitude
+ *
+ * The zenith is brought once into the frame of the index, then the points
+ * are searched in the cone of radius 90 - h0 around it: whole regions of the
+ * sky below the limit are skipped. Altitudes are computed for the points
+ * found only.
+ * r is typically rot_get_equ_to_hor () for equatorial coordinates, multiplied
+ * by the precession and nutation matrix of cat_get_epoch () for an index of
+ * catalog positions of J2000.0.
+ *
+ * @param[in] idx the index
+ * @param[in] r rotation from the index frame to the horizontal frame of the observer
+ * @param[in] h0 minimum altitude, in degrees
+ * @param[in] max size of the arrays id and h
+ * @param[out] id index of the points found in the arrays given to spi_build(), in no particular order
+ * @param[out] h altitudes of the points found, in degrees
+ *
+ * @return number of points found. Only the first max are stored.
+ */
+size_t
+spi_visible (const struct spi_s *idx, const struct rot_mat_s *r, double h0,
+             size_t max, size_t *id, double *h)
+{
+    struct spi_visible_s v = { id, h, max, 0 };
+    double sin_h[SPI_BLOCK];
+
+    spi_cone (idx, r, (const double[]) { 0, 0, 1 }, 90 - h0,
+              spi_visible_add, &v);
+
+    /* h holds sin (h) so far */
+    size_t n = v.n < max ? v.n : max;
+    for (size_t i = 0; i < n; i += SPI_BLOCK) {
+        size_t m = n - i < SPI_BLOCK ? n - i : SPI_BLOCK;
+        memcpy (sin_h, h + i, m * sizeof *sin_h);
+        m_asind_batch (sin_h, m, h + i);
+    }
+    return v.n;
+}
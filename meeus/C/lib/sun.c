@@ -67,15 +67,33 @@ sun_get_param (double jde, double *O, double *nu, double *R)
                  2);
     /* Center of the sun */
     double C = polynom ((double[]) { 1.914602, -0.004817, -0.000014 }, T,
-                        2) * sind (M) + (0.019993 -
-                                         0.000101 * T) * sind (2 * M) +
-        0.000289 * sind (3 * M);
+                        2) * m_sind (M) + (0.019993 -
+                                         0.000101 * T) * m_sind (2 * M) +
+        0.000289 * m_sind (3 * M);
     /* Sun true longitude */
     *O = L0 + C;
     /* Sun true anomaly */
     *nu = M + C;
     /* Sun radius vector */
-    *R = (1.000001018 * (1 - e * e)) / (1 + e * cosd (*nu));
+    *R = (1.000001018 * (1 - e * e)) / (1 + e * m_cosd (*nu));
+}
+
+/**
+ * @brief Get Sun true geometric longitude, with the low accuracy method
+ *
+ * Implements Meeus formulas 25.2 to 25.5. Precise to about 0.01 degree.
+ * Referred to the mean equinox of the date.
+ *
+ * @param[in] jde Julian Day Ephemeris (Dynamical time)
+ * @param[out] O sun true longitude in degrees
+ * @param[out] R sun radius vector in AU
+ */
+void
+sun_geometric_coord (double jde, double *O, double *R)
+{
+    double nu;
+
+    sun_get_param (jde, O, &nu, R);
 }
 
 /**
@@ -104,47 +122,46 @@ sun_get_aberration_correction (double jde, double R, m_acc_t accuracy)
          i < (sizeof aberration_coef_0) / (sizeof aberration_coef_0[0]);
          i++) {
         double *coef = aberration_coef_0[i];
-        deltaLambda += coef[0] * sind (coef[1] + coef[2] * tau);
+        deltaLambda += coef[0] * m_sind (coef[1] + coef[2] * tau);
     }
     for (int i = 0;
          i < (sizeof aberration_coef_1) / (sizeof aberration_coef_1[0]);
          i++) {
         double *coef = aberration_coef_1[i];
-        deltaLambda += coef[0] * tau * sind (coef[1] + coef[2] * tau);
+        deltaLambda += coef[0] * tau * m_sind (coef[1] + coef[2] * tau);
     }
     for (int i = 0;
          i < (sizeof aberration_coef_2) / (sizeof aberration_coef_2[0]);
          i++) {
         double *coef = aberration_coef_2[i];
-        deltaLambda += coef[0] * tau * tau * sind (coef[1] + coef[2] * tau);
+        deltaLambda += coef[0] * tau * tau * m_sind (coef[1] + coef[2] * tau);
     }
     for (int i = 0;
          i < (sizeof aberration_coef_3) / (sizeof aberration_coef_3[0]);
          i++) {
         double *coef = aberration_coef_3[i];
         deltaLambda +=
-            coef[0] * tau * tau * tau * sind (coef[1] + coef[2] * tau);
+            coef[0] * tau * tau * tau * m_sind (coef[1] + coef[2] * tau);
     }
     return -0.005775518 * R * deltaLambda;
 }
 
 /**
- * @brief Get sun mean ecliptic geocentric coordinates
- *
- * This uses the high accuracy method, with VSOP87. Coordinates are returned in the FK5 reference.
+ * @brief geometric ecliptic coordinates of the Sun, from VSOP87
  *
  * @param[in] jde Julian Day Ephemeris (Dynamical time)
+ * @param[in] accuracy M_MED_ACC for the truncated Earth series, otherwise the complete one
  * @param[out] lambda Sun ecliptic longitude in degrees
  * @param[out] beta Sun ecliptic latitude in degrees
  * @param[out] R Sun radius vector in AU
- *
  */
-void
-sun_mean_ecliptic_coord (double jde, double *lambda, double *beta, double *R)
+static void
+sun_mean_ecl (double jde, m_acc_t accuracy, double *lambda, double *beta,
+              double *R)
 {
     double coord[3];
 
-    vso_vsop87d_coordinates (jde, EARTH, coord);
+    vso_vsop87d_earth_coordinates (jde, accuracy, coord);
     *lambda = rerange (coord[0] + 180, 360.0);
     *beta = -coord[1];
     *R = coord[2];
@@ -154,10 +171,61 @@ sun_mean_ecliptic_coord (double jde, double *lambda, double *beta, double *R)
     double T = get_century_since_j2000 (jde);
     double lambdaprime = *lambda - 1.397 * T - 0.00031 * T * T;
     *lambda -= 0.09033 / 3600.0;
-    *beta += 0.03916 * (cosd (lambdaprime) - sind (lambdaprime)) / 3600.0;
+    *beta += 0.03916 * (m_cosd (lambdaprime) - m_sind (lambdaprime)) / 3600.0;
 #endif
 }
 
+/**
+ * @brief Get sun mean ecliptic geocentric coordinates
+ *
+ * This uses the high accuracy method, with VSOP87. Coordinates are returned in the FK5 reference.
+ *
+ * @param[in] jde Julian Day Ephemeris (Dynamical time)
+ * @param[out] lambda Sun ecliptic longitude in degrees
+ * @param[out] beta Sun ecliptic latitude in degrees
+ * @param[out] R Sun radius vector in AU
+ *
+ */
+void
+sun_mean_ecliptic_coord (double jde, double *lambda, double *beta, double *R)
+{
+    sun_mean_ecl (jde, M_HIGH_ACC, lambda, beta, R);
+}
+
+/**
+ * @brief apparent ecliptic coordinates of the Sun and nutation
+ *
+ * @param[in] jde Julian Day Ephemeris (Dynamical time)
+ * @param[in] accuracy If M_HIGH_ACC, use VSOP87 and the complete nutation.
+ * If M_MED_ACC, use the truncated Earth series, the low accuracy nutation
+ * and Meeus 25.10. If M_LOW_ACC, use Meeus 25.8.
+ * @param[out] s lambda, beta, R, dpsi and deps are set
+ */
+static void
+sun_apparent_ecl (double jde, m_acc_t accuracy, struct sun_apparent_s *s)
+{
+    if (accuracy == M_LOW_ACC) {
+        double O, nu, so, co;
+        double omega = 125.04 - 1934.136 * get_century_since_j2000 (jde);
+
+        sun_get_param (jde, &O, &nu, &s->R);
+        m_sincosd (omega, &so, &co);
+        /* Meeus 25.8: main terms of the nutation, and the aberration */
+        s->lambda = O - 0.00569 - 0.00478 * so;
+        s->beta = 0;
+        s->dpsi = deg_to_arcsec (-0.00478 * so);
+        s->deps = deg_to_arcsec (0.00256 * co);
+        return;
+    }
+    m_acc_t nut_acc = accuracy == M_MED_ACC ? M_LOW_ACC : M_HIGH_ACC;
+    sun_mean_ecl (jde, accuracy, &s->lambda, &s->beta, &s->R);
+    ecl_nutation (jde, nut_acc, &s->dpsi, &s->deps);
+    /* Correct for nutation and aberration */
+    s->lambda += (s->dpsi + sun_get_aberration_correction (jde, s->R,
+                                                           nut_acc)) /
+        3600.0;
+}
+
 /**
  * @brief Get sun apparent ecliptic geocentric coordinates
  *
@@ -168,19 +236,78 @@ sun_mean_ecliptic_coord (double jde, double *lambda, double *beta, double *R)
  * @param[out] beta Sun ecliptic latitude in degrees
  * @param[out] R Sun radius vector in AU
  *
+ * @see sun_apparent_coord () to get the equatorial coordinates and the nutation as well
  */
 void
 sun_apparent_ecliptic_coord (double jde, double *lambda, double *beta,
                              double *R)
 {
-    double correction;
-    sun_mean_ecliptic_coord (jde, lambda, beta, R);
-    /* Correct for nutation */
-    correction = ecl_nut_in_lon (jde, 1);
-    /* Correct for aberration */
-    correction += sun_get_aberration_correction (jde, *R, 1);
+    struct sun_apparent_s s;
 
-    *lambda += correction / 3600.0;
+    sun_apparent_ecl (jde, M_HIGH_ACC, &s);
+    *lambda = s.lambda;
+    *beta = s.beta;
+    *R = s.R;
+}
+
+/**
+ * @brief Get the apparent coordinates of the Sun and the nutation
+ *
+ * Nutation (in longitude and in obliquity), aberration and obliquity are
+ * computed once and shared by the ecliptic and the equatorial coordinates.
+ * Equatorial coordinates use the true obliquity of the ecliptic (Meeus
+ * chapter 25).
+ *
+ * @param[in] jde Julian Day Ephemeris (Dynamical time)
+ * @param[in] accuracy M_HIGH_ACC: complete VSOP87 and nutation.
+ * M_MED_ACC: truncated VSOP87 (115 terms), within 0.9" (0.00025 degree) of
+ * M_HIGH_ACC between 1900 and 2100, about 20 times faster (see prg/bench_sun).
+ * M_LOW_ACC: Meeus 25.2 to 25.8, within 40" (0.011 degree).
+ * @param[out] s apparent coordinates of the Sun
+ *
+ * @return status of the function
+ * @retval M_INVALID_RANGE_ERR jde is out of the validity range of the obliquity
+ * @retval M_NO_ERR function completed successfully
+ */
+m_err_t
+sun_apparent_coord (double jde, m_acc_t accuracy, struct sun_apparent_s *s)
+{
+    double epsilon;
+    m_err_t err = ecl_mean_obl_ecliptic (jde, &epsilon, 1);
+
+    if (err)
+        return err;
+    sun_apparent_ecl (jde, accuracy, s);
+    s->epsilon = arcsec_to_deg (epsilon + s->deps);
+    coo_ecl_to_equ (s->lambda, s->beta, s->epsilon, &s->alpha, &s->delta);
+    s->alpha = rerange (s->alpha, 360.0);
+    return M_NO_ERR;
+}
+
+/**
+ * @brief Get the apparent coordinates of the Sun at several times
+ *
+ * Batch version of sun_apparent_coord ().
+ *
+ * @param[in] jde Julian Days Ephemeris (Dynamical time)
+ * @param[in] n number of times
+ * @param[in] accuracy M_HIGH_ACC, M_MED_ACC or M_LOW_ACC (see sun_apparent_coord ())
+ * @param[out] s apparent coordinates of the Sun, for each time
+ *
+ * @return status of the function
+ * @retval M_INVALID_RANGE_ERR a jde is out of the validity range of the obliquity
+ * @retval M_NO_ERR function completed successfully
+ */
+m_err_t
+sun_apparent_coord_batch (const double *jde, size_t n, m_acc_t accuracy,
+                          struct sun_apparent_s *s)
+{
+    for (size_t i = 0; i < n; i++) {
+        m_err_t err = sun_apparent_coord (jde[i], accuracy, &s[i]);
+        if (err)
+            return err;
+    }
+    return M_NO_ERR;
 }
 
 /**
@@ -189,7 +316,7 @@ sun_apparent_ecliptic_coord (double jde, double *lambda, double *beta,
  * @param[in] jde Julian Day Ephemeris (Dynamical time)
  * @param[out] alpha Sun right ascension in degrees
  * @param[out] delta Sun declination in degrees
- * @param[in] accuracy If M_HIGH_ACC, use high accuracy method. If M_LOW_ACC, use low accuracy method
+ * @param[in] accuracy M_HIGH_ACC, M_MED_ACC or M_LOW_ACC (see sun_apparent_coord ())
  *
  * @return status of the function
  * @retval M_INVALID_RANGE_ERR jde is negative
@@ -208,14 +335,15 @@ sun_mean_equatorial_coord (double jde, double *alpha, double *delta,
     epsilon = arcsec_to_deg (epsilon);
     if (accuracy == M_LOW_ACC) {
         sun_get_param (jde, &O, &nu, &R);
-        *alpha =
-            rerange (rad_to_deg (atan2 (cosd (epsilon) * sind (O), cosd (O))),
-                     360);
-        *delta = rad_to_deg (asin (sind (epsilon) * sind (O)));
+        double se, ce, sO, cO;
+        m_sincosd (epsilon, &se, &ce);
+        m_sincosd (O, &sO, &cO);
+        *alpha = rerange (m_atan2d (ce * sO, cO), 360);
+        *delta = m_asind (se * sO);
         return M_NO_ERR;
     }
     double lambda, beta;
-    sun_mean_ecliptic_coord (jde, &lambda, &beta, &R);
+    sun_mean_ecl (jde, accuracy, &lambda, &beta, &R);
     /* Then convert to equatorial coordinates */
     coo_ecl_to_equ (lambda, beta, epsilon, alpha, delta);
     return M_NO_ERR;
@@ -229,42 +357,24 @@ sun_mean_equatorial_coord (double jde, double *alpha, double *delta,
  * @param[in] jde Julian Day Ephemeris (Dynamical time)
  * @param[out] alpha Sun right ascension in degrees
  * @param[out] delta Sun declination in degrees
- * @param[in] accuracy If M_HIGH_ACC, use high accuracy method. If M_LOW_ACC, use low accuracy method
+ * @param[in] accuracy M_HIGH_ACC, M_MED_ACC or M_LOW_ACC (see sun_apparent_coord ())
  *
  * @return status of the function
  * @retval M_INVALID_RANGE_ERR jde is negative
  * @retval M_NO_ERR function completed successfully
+ *
+ * @see sun_apparent_coord ()
  */
 m_err_t
 sun_apparent_equatorial_coord (double jde, double *alpha, double *delta,
                                m_acc_t accuracy)
 {
-    double O, nu, R, epsilon, T, omega, lambda, beta;
-    m_err_t err;
+    struct sun_apparent_s s;
+    m_err_t err = sun_apparent_coord (jde, accuracy, &s);
 
-    err = ecl_mean_obl_ecliptic (jde, &epsilon, 1);
     if (err)
         return err;
-    epsilon = arcsec_to_deg (epsilon);
-
-    if (accuracy == M_LOW_ACC) {
-        sun_get_param (jde, &O, &nu, &R);
-        T = get_century_since_j2000 (jde);
-        omega = 125.04 - 1934.136 * T;
-        lambda = O - 0.00569 - 0.00478 * sind (omega);
-
-        epsilon += 0.00256 * cosd (omega);
-
-        *alpha =
-            rerange (rad_to_deg
-                     (atan2 (cosd (epsilon) * sind (lambda), cosd (lambda))),
-                     360);
-        *delta = rad_to_deg (asin (sind (epsilon) * sind (lambda)));
-        return M_NO_ERR;
-    }
-
-    sun_apparent_ecliptic_coord (jde, &lambda, &beta, &R);
-    coo_ecl_to_equ (lambda, beta, epsilon, alpha, delta);
-    *alpha = rerange (*alpha, 360.0);
+    *alpha = s.alpha;
+    *delta = s.delta;
     return M_NO_ERR;
 }
@@ -0,0 +1,244 @@
+/**
+ * @file sundial.c
+ * Meeus chapter 58. Planar sundials.
+ *
+ * The dial is a plane of any orientation with a stylus perpendicular to it.
+ * The shadow of the tip of the stylus is computed for grids of hour angles
+ * and declinations (hour lines and declination lines), or for grids of
+ * dates and clock times with the true declination and the equation of
+ * time of the Sun (analemmas).
+ *
+ * For the analemmas, the Sun is computed once a day by eqt_table () and
+ * interpolated, so that dense grids cost about one Sun position per day.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "meeus.h"
+
+/* number of dates per chunk of the parallel loop */
+#define SDL_GRAIN 16
+
+/**
+ * @brief Compute the constants of a sundial
+ *
+ * @param[in] phi latitude of the dial, in degrees
+ * @param[in] D gnomonic declination: azimuth of the perpendicular to the
+ * plane, measured westward from south, in degrees
+ * @param[in] z zenithal distance of the stylus, in degrees
+ * @param[in] a length of the stylus
+ * @param[out] dial sundial constants
+ */
+void
+sdl_init (double phi, double D, double z, double a, struct sdl_dial_s *dial)
+{
+    dial->a = a;
+    m_sincosd (phi, &dial->sp, &dial->cp);
+    m_sincosd (D, &dial->sD, &dial->cD);
+    m_sincosd (z, &dial->sz, &dial->cz);
+    dial->P = dial->sp * dial->cz - dial->cp * dial->sz * dial->cD;
+    /* convergence point of the hour lines, undefined if P = 0 */
+    dial->xc = a * dial->cp * dial->sD / dial->P;
+    dial->yc = -a * (dial->sp * dial->sz + dial->cp * dial->cz * dial->cD)
+        / dial->P;
+}
+
+/**
+ * @brief shadow of the tip of the stylus, from sine and cosine of H and tan delta
+ */
+static int
+sdl_shadow_sc (const struct sdl_dial_s *d, double sH, double cH, double td,
+               double *x, double *y)
+{
+    double Q = d->sD * d->sz * sH + (d->cp * d->cz + d->sp * d->sz * d->cD)
+        * cH + d->P * td;
+
+    /* the plane is in the shade, or the Sun is below the horizon */
+    if (!(Q > 0) || !(d->sp * td + d->cp * cH > 0)) {
+        *x = *y = NAN;
+        return 0;
+    }
+    double Nx = d->cD * sH - d->sD * (d->sp * cH - d->cp * td);
+    double Ny = d->cz * d->sD * sH
+        - (d->cp * d->sz - d->sp * d->cz * d->cD) * cH
+        - (d->sp * d->sz + d->cp * d->cz * d->cD) * td;
+    *x = d->a * Nx / Q;
+    *y = d->a * Ny / Q;
+    return 1;
+}
+
+/**
+ * @brief Compute the shadow of the tip of the stylus
+ *
+ * Implements Meeus chapter 58. The x axis is horizontal in the plane of the
+ * dial, the y axis is the line of greatest slope, upwards. The origin is
+ * the foot of the stylus.
+ *
+ * @param[in] dial sundial constants, from sdl_init ()
+ * @param[in] H local hour angle of the Sun, measured westward from south, in degrees
+ * @param[in] delta declination of the Sun, in degrees
+ * @param[out] x abscissa of the shadow, or NAN
+ * @param[out] y ordinate of the shadow, or NAN
+ *
+ * @return 1 if there is a shadow, 0 if the Sun is below the horizon or
+ * behind the plane of the dial
+ */
+int
+sdl_shadow (const struct sdl_dial_s *dial, double H, double delta, double *x,
+            double *y)
+{
+    double sH, cH;
+
+    m_sincosd (H, &sH, &cH);
+    return sdl_shadow_sc (dial, sH, cH, m_tand (delta), x, y);
+}
+
+/**
+ * @brief Compute hour lines and declination lines
+ *
+ * @param[in] dial sundial constants, from sdl_init ()
+ * @param[in] H local hour angles of the Sun, in degrees
+ * @param[in] nh number of hour angles
+ * @param[in] delta declinations of the Sun, in degrees
+ * @param[in] nd number of declinations
+ * @param[out] x abscissae, nh x nd, hour angle by hour angle. NAN without shadow.
+ * @param[out] y ordinates, nh x nd, hour angle by hour angle. NAN without shadow.
+ *
+ * @return error status of the function
+ * @retval M_NO_MEM_ERR memory allocation failure
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+sdl_lines (const struct sdl_dial_s *dial, const double *H, size_t nh,
+           const double *delta, size_t nd, double *x, double *y)
+{
+    double *td = malloc (nd * sizeof *td);
+
+    if (!td)
+        return M_NO_MEM_ERR;
+    for (size_t j = 0; j < nd; j++)
+        td[j] = m_tand (delta[j]);
+    for (size_t i = 0; i < nh; i++) {
+        double sH, cH;
+        m_sincosd (H[i], &sH, &cH);
+        for (size_t j = 0; j < nd; j++)
+            sdl_shadow_sc (dial, sH, cH, td[j], &x[i * nd + j],
+                           &y[i * nd + j]);
+    }
+    free (td);
+    return M_NO_ERR;
+}
+
+/**
+ * @brief context of the analemma kernel
+ */
+struct sdl_ctx_s
+{
+    const struct sdl_dial_s *dial;
+    double jd0;                 /* (UT) julian day of the first date */
+    double day_step;
+    double t0;                  /* first clock time, hours */
+    double t_step;
+    size_t n_times;
+    double zone;
+    double L;
+    double dt;                  /* TD - UT, days */
+    double node0;               /* JDE of the first Sun node */
+    const double *eqt;          /* equation of time at the nodes, degrees */
+    const double *delta;        /* declination at the nodes, degrees */
+    double *x;
+    double *y;
+};
+
+/**
+ * @brief fill the shadows of the dates [begin, end)
+ *
+ * @param[in] begin first date
+ * @param[in] end last date + 1
+ * @param[in] arg context
+ */
+static void
+sdl_dates (size_t begin, size_t end, void *arg)
+{
+    const struct sdl_ctx_s *ctx = arg;
+
+    for (size_t i = begin; i < end; i++) {
+        for (size_t j = 0; j < ctx->n_times; j++) {
+            size_t o = i * ctx->n_times + j;
+            double ut = ctx->t0 + j * ctx->t_step - ctx->zone;
+            double t = ctx->jd0 + i * ctx->day_step + ut / 24 + ctx->dt
+                - ctx->node0;
+            size_t k = (size_t) t;
+            double sH, cH;
+            /* apparent hour angle: mean hour angle plus equation of time */
+            m_sincosd (15 * (ut - 12) - ctx->L
+                       + interp4 (ctx->eqt + k, t - k), &sH, &cH);
+            sdl_shadow_sc (ctx->dial, sH, cH,
+                           m_tand (interp4 (ctx->delta + k, t - k)),
+                           &ctx->x[o], &ctx->y[o]);
+        }
+    }
+}
+
+/**
+ * @brief Compute analemmas of a sundial
+ *
+ * Shadow of the tip of the stylus at clock times t0 + j * t_step of the
+ * dates jd0 + i * day_step, with the true declination and the equation of
+ * time of the Sun. For a given time, the shadows of all dates draw the
+ * analemma of that time. For a given date, they draw the declination line
+ * of that date.
+ *
+ * @param[in] dial sundial constants, from sdl_init ()
+ * @param[in] L longitude of the dial, negative towards east
+ * @param[in] zone clock time minus UT, in hours
+ * @param[in] jd (UT) julian day of 0h UT of the first date
+ * @param[in] day_step step between dates, in days
+ * @param[in] n_days number of dates
+ * @param[in] t0 first clock time, in hours
+ * @param[in] t_step step between clock times, in hours
+ * @param[in] n_times number of clock times
+ * @param[in] accuracy accuracy of the Sun coordinates
+ * @param[in] nthreads number of threads. 0 to use all processors.
+ * @param[out] x abscissae, n_days x n_times, date by date. NAN without shadow.
+ * @param[out] y ordinates, n_days x n_times, date by date. NAN without shadow.
+ *
+ * @return error status of the function
+ * @retval M_INVALID_RANGE_ERR empty grid, negative step or date out of range
+ * @retval M_NO_MEM_ERR memory allocation failure
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+sdl_analemma (const struct sdl_dial_s *dial, double L, double zone,
+              double jd, double day_step, size_t n_days, double t0,
+              double t_step, size_t n_times, m_acc_t accuracy, int nthreads,
+              double *x, double *y)
+{
+    struct sdl_ctx_s ctx = { dial, jd, day_step, t0, t_step, n_times, zone,
+        L, dy_ut_to_dt (jd) - jd, 0, NULL, NULL, x, y
+    };
+
+    if (n_days == 0 || n_times == 0 || !(day_step >= 0) || !(t_step >= 0))
+        return M_INVALID_RANGE_ERR;
+
+    /* daily Sun nodes, from one before the first time to two after the last */
+    double first = jd + (t0 - zone) / 24 + ctx.dt;
+    double last = jd + (n_days - 1) * day_step
+        + (t0 + (n_times - 1) * t_step - zone) / 24 + ctx.dt;
+    ctx.node0 = floor (first) - 1;
+    size_t m = (size_t) (floor (last) - ctx.node0) + 3;
+    double *buf = malloc (2 * m * sizeof *buf);
+    if (!buf)
+        return M_NO_MEM_ERR;
+    m_err_t err = eqt_table (ctx.node0, 1, m, accuracy, nthreads, buf,
+                             buf + m);
+
+    if (!err) {
+        ctx.eqt = buf;
+        ctx.delta = buf + m;
+        thr_for (n_days, SDL_GRAIN, nthreads, sdl_dates, &ctx);
+    }
+    free (buf);
+    return err;
+}
@@ -0,0 +1,358 @@
+/**
+ * @file timescale.c
+ * Time scales: UTC, TAI, TT and TDB.
+ *
+ * UTC -> TAI uses the leap seconds table, TAI -> TT is the constant
+ * 32.184 s offset, TT -> TDB is the periodic term of Fairhead and Bretagnon
+ * (USNO circular 179, eq. 2.6). All julian days are doubles: their
+ * resolution is about 40 microseconds at current epochs.
+ */
+#include <stdio.h>
+#include <time.h>
+#include <math.h>
+#include "meeus.h"
+
+/**
+ * @brief leap seconds table: JD (UTC) of introduction and TAI - UTC from that date on
+ *
+ * From IERS Bulletin C. To be updated when a new leap second is announced.
+ */
+static const double ts_leap_seconds[][2] = {
+    {2441317.5, 10},            /* 1972 Jan 1 */
+    {2441499.5, 11},            /* 1972 Jul 1 */
+    {2441683.5, 12},            /* 1973 Jan 1 */
+    {2442048.5, 13},            /* 1974 Jan 1 */
+    {2442413.5, 14},            /* 1975 Jan 1 */
+    {2442778.5, 15},            /* 1976 Jan 1 */
+    {2443144.5, 16},            /* 1977 Jan 1 */
+    {2443509.5, 17},            /* 1978 Jan 1 */
+    {2443874.5, 18},            /* 1979 Jan 1 */
+    {2444239.5, 19},            /* 1980 Jan 1 */
+    {2444786.5, 20},            /* 1981 Jul 1 */
+    {2445151.5, 21},            /* 1982 Jul 1 */
+    {2445516.5, 22},            /* 1983 Jul 1 */
+    {2446247.5, 23},            /* 1985 Jul 1 */
+    {2447161.5, 24},            /* 1988 Jan 1 */
+    {2447892.5, 25},            /* 1990 Jan 1 */
+    {2448257.5, 26},            /* 1991 Jan 1 */
+    {2448804.5, 27},            /* 1992 Jul 1 */
+    {2449169.5, 28},            /* 1993 Jul 1 */
+    {2449534.5, 29},            /* 1994 Jul 1 */
+    {2450083.5, 30},            /* 1996 Jan 1 */
+    {2450630.5, 31},            /* 1997 Jul 1 */
+    {2451179.5, 32},            /* 1999 Jan 1 */
+    {2453736.5, 33},            /* 2006 Jan 1 */
+    {2454832.5, 34},            /* 2009 Jan 1 */
+    {2456109.5, 35},            /* 2012 Jul 1 */
+    {2457204.5, 36},            /* 2015 Jul 1 */
+    {2457754.5, 37}             /* 2017 Jan 1 */
+};
+
+#define TS_N_LEAP ((int) ((sizeof ts_leap_seconds) / (sizeof *ts_leap_seconds)))
+
+/* TT - TAI in seconds */
+#define TS_TT_TAI 32.184
+
+/**
+ * @brief find the leap seconds table entry in effect at a date
+ *
+ * The search starts from a previous result, so that a sorted sequence of
+ * dates is handled in amortized constant time. Falls back to a binary search
+ * when the date is before the hint.
+ *
+ * @param[in] jd Julian Day
+ * @param[in] col 0 to compare jd with UTC dates of introduction, 1 to compare with TAI dates
+ * @param[in] hint index returned by a previous call, or 0
+ *
+ * @return index of the entry in effect, -1 before 1972 Jan 1st
+ */
+static inline int
+ts_leap_index (double jd, int col, int hint)
+{
+    /* TAI date of introduction is the UTC date plus the new TAI - UTC */
+#define TS_LEAP_JD(i) (ts_leap_seconds[i][0] + col * ts_leap_seconds[i][1] / DT_SECS_PER_DAY)
+    if (hint < 0 || hint >= TS_N_LEAP || jd < TS_LEAP_JD (hint)) {
+        int lo = -1, hi = TS_N_LEAP - 1;
+        while (lo < hi) {
+            int mid = (lo + hi + 1) / 2;
+            if (TS_LEAP_JD (mid) <= jd)
+                lo = mid;
+            else
+                hi = mid - 1;
+        }
+        return lo;
+    }
+    while (hint + 1 < TS_N_LEAP && TS_LEAP_JD (hint + 1) <= jd)
+        hint++;
+    return hint;
+#undef TS_LEAP_JD
+}
+
+/**
+ * @brief Get TAI - UTC
+ *
+ * Binary search in the leap seconds table.
+ *
+ * @param[in] jd Julian Day (UTC)
+ *
+ * @return TAI - UTC in seconds. 10 seconds before 1972 Jan 1st, where
+ * UTC was not defined by leap seconds.
+ */
+double
+ts_get_tai_utc (double jd)
+{
+    int i = ts_leap_index (jd, 0, -1);
+    return ts_leap_seconds[i < 0 ? 0 : i][1];
+}
+
+/**
+ * @brief Convert UTC to TAI
+ *
+ * @param[in] jd_utc Julian Day (UTC)
+ * @param[out] jd_tai Julian Day (TAI)
+ *
+ * @return error status of the function
+ * @retval M_INVALID_RANGE_ERR jd_utc is before 1972 Jan 1st
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+ts_utc_to_tai (double jd_utc, double *jd_tai)
+{
+    int i = ts_leap_index (jd_utc, 0, -1);
+    if (i < 0)
+        return M_INVALID_RANGE_ERR;
+    *jd_tai = jd_utc + ts_leap_seconds[i][1] / DT_SECS_PER_DAY;
+    return M_NO_ERR;
+}
+
+/**
+ * @brief TAI to UTC with a given entry of the leap seconds table
+ *
+ * @param[in] jd_tai Julian Day (TAI)
+ * @param[in] i entry in effect at jd_tai, from ts_leap_index (jd_tai, 1, ...)
+ *
+ * @return Julian Day (UTC). Inside the leap second that ends entry i, 0h UTC
+ * of the next day.
+ */
+static inline double
+ts_tai_to_utc_entry (double jd_tai, int i)
+{
+    double jd_utc = jd_tai - ts_leap_seconds[i][1] / DT_SECS_PER_DAY;
+
+    if (i + 1 < TS_N_LEAP && jd_utc >= ts_leap_seconds[i + 1][0])
+        return ts_leap_seconds[i + 1][0];
+    return jd_utc;
+}
+
+/**
+ * @brief Convert TAI to UTC
+ *
+ * An instant inside a leap second is returned as 0h UTC of the next day.
+ *
+ * @param[in] jd_tai Julian Day (TAI)
+ * @param[out] jd_utc Julian Day (UTC)
+ *
+ * @return error status of the function
+ * @retval M_INVALID_RANGE_ERR jd_tai is before 1972 Jan 1st
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+ts_tai_to_utc (double jd_tai, double *jd_utc)
+{
+    int i = ts_leap_index (jd_tai, 1, -1);
+    if (i < 0)
+        return M_INVALID_RANGE_ERR;
+    *jd_utc = ts_tai_to_utc_entry (jd_tai, i);
+    return M_NO_ERR;
+}
+
+/**
+ * @brief Convert TAI to TT
+ *
+ * @param[in] jd_tai Julian Day (TAI)
+ *
+ * @return Julian Day Ephemeris (TT)
+ */
+double
+ts_tai_to_tt (double jd_tai)
+{
+    return jd_tai + TS_TT_TAI / DT_SECS_PER_DAY;
+}
+
+/**
+ * @brief Convert TT to TAI
+ *
+ * @param[in] jde Julian Day Ephemeris (TT)
+ *
+ * @return Julian Day (TAI)
+ */
+double
+ts_tt_to_tai (double jde)
+{
+    return jde - TS_TT_TAI / DT_SECS_PER_DAY;
+}
+
+/**
+ * @brief Get TDB - TT
+ *
+ * Periodic terms of Fairhead and Bretagnon, accurate to about 10 microseconds
+ * between 1600 and 2200.
+ *
+ * @param[in] jde Julian Day Ephemeris (TT)
+ *
+ * @return TDB - TT in seconds
+ */
+double
+ts_get_tdb_tt (double jde)
+{
+    double T = get_century_since_j2000 (jde);
+
+    return 0.001657 * sin (628.3076 * T + 6.2401) +
+        0.000022 * sin (575.3385 * T + 4.2970) +
+        0.000014 * sin (1256.6152 * T + 6.1969) +
+        0.000005 * sin (606.9777 * T + 4.0212) +
+        0.000005 * sin (52.9691 * T + 0.4444) +
+        0.000002 * sin (21.3299 * T + 5.5431) +
+        0.000010 * T * sin (628.3076 * T + 4.2490);
+}
+
+/**
+ * @brief Convert TT to TDB
+ *
+ * @param[in] jde Julian Day Ephemeris (TT)
+ *
+ * @return Julian Day Ephemeris (TDB)
+ */
+double
+ts_tt_to_tdb (double jde)
+{
+    return jde + ts_get_tdb_tt (jde) / DT_SECS_PER_DAY;
+}
+
+/**
+ * @brief Convert TDB to TT
+ *
+ * @param[in] jde Julian Day Ephemeris (TDB)
+ *
+ * @return Julian Day Ephemeris (TT)
+ */
+double
+ts_tdb_to_tt (double jde)
+{
+    /* TDB - TT evaluated at TDB instead of TT: error well below 1 ns */
+    return jde - ts_get_tdb_tt (jde) / DT_SECS_PER_DAY;
+}
+
+/**
+ * @brief Convert UTC to TT
+ *
+ * @param[in] jd_utc Julian Day (UTC)
+ * @param[out] jde Julian Day Ephemeris (TT)
+ *
+ * @return error status of the function
+ * @retval M_INVALID_RANGE_ERR jd_utc is before 1972 Jan 1st
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+ts_utc_to_tt (double jd_utc, double *jde)
+{
+    double jd_tai;
+    m_err_t err = ts_utc_to_tai (jd_utc, &jd_tai);
+    if (err)
+        return err;
+    *jde = ts_tai_to_tt (jd_tai);
+    return M_NO_ERR;
+}
+
+/**
+ * @brief Convert TT to UTC
+ *
+ * @param[in] jde Julian Day Ephemeris (TT)
+ * @param[out] jd_utc Julian Day (UTC)
+ *
+ * @return error status of the function
+ * @retval M_INVALID_RANGE_ERR jde is before 1972 Jan 1st
+ * @retval M_NO_ERR the function executed correctly
+ */
+m_err_t
+ts_tt_to_utc (double jde, double *jd_utc)
+{
+    return ts_tai_to_utc (ts_tt_to_tai (jde), jd_utc);
+}
+
+/**
+ * @brief Convert an array of UTC dates to TT
+ *
+ * The leap seconds table position is carried from one element to the
+ * next, so that sorted arrays are converted without searching the table
+ * for each element. Unsorted arrays are still converted correctly.
+ *
+ * @param[in] jd_utc Julian Days (UTC)
+ * @param[in] n number of dates
+ * @param[out] jde Julian Days Ephemeris (TT)
+ * @param[out] err per date error status (M_NO_ERR, or M_INVALID_RANGE_ERR before 1972)
+ *
+ * @return error status of the function
+ * @retval M_INVALID_RANGE_ERR at least one date is before 1972 Jan 1st
+ * @retval M_NO_ERR all dates were converted
+ */
+m_err_t
+ts_utc_to_tt_batch (const double *restrict jd_utc, size_t n,
+                    double *restrict jde, unsigned char *restrict err)
+{
+    int cursor = 0, n_err = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        cursor = ts_leap_index (jd_utc[i], 0, cursor);
+        err[i] = cursor < 0 ? M_INVALID_RANGE_ERR : M_NO_ERR;
+        n_err += cursor < 0;
+        jde[i] = jd_utc[i] + (ts_leap_seconds[cursor < 0 ? 0 : cursor][1] +
+                              TS_TT_TAI) / DT_SECS_PER_DAY;
+    }
+    return n_err ? M_INVALID_RANGE_ERR : M_NO_ERR;
+}
+
+/**
+ * @brief Convert an array of TT dates to UTC
+ *
+ * Same cursor strategy as ts_utc_to_tt_batch ().
+ *
+ * @param[in] jde Julian Days Ephemeris (TT)
+ * @param[in] n number of dates
+ * @param[out] jd_utc Julian Days (UTC)
+ * @param[out] err per date error status (M_NO_ERR, or M_INVALID_RANGE_ERR before 1972)
+ *
+ * @return error status of the function
+ * @retval M_INVALID_RANGE_ERR at least one date is before 1972 Jan 1st
+ * @retval M_NO_ERR all dates were converted
+ */
+m_err_t
+ts_tt_to_utc_batch (const double *restrict jde, size_t n,
+                    double *restrict jd_utc, unsigned char *restrict err)
+{
+    int cursor = 0, n_err = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        double jd_tai = ts_tt_to_tai (jde[i]);
+        cursor = ts_leap_index (jd_tai, 1, cursor);
+        err[i] = cursor < 0 ? M_INVALID_RANGE_ERR : M_NO_ERR;
+        n_err += cursor < 0;
+        jd_utc[i] = ts_tai_to_utc_entry (jd_tai, cursor < 0 ? 0 : cursor);
+    }
+    return n_err ? M_INVALID_RANGE_ERR : M_NO_ERR;
+}
+
+/**
+ * @brief Convert an array of TT dates to TDB
+ *
+ * @param[in] jde Julian Days Ephemeris (TT)
+ * @param[in] n number of dates
+ * @param[out] jde_tdb Julian Days Ephemeris (TDB)
+ */
+void
+ts_tt_to_tdb_batch (const double *restrict jde, size_t n,
+                    double *restrict jde_tdb)
+{
+    for (size_t i = 0; i < n; i++)
+        jde_tdb[i] = ts_tt_to_tdb (jde[i]);
+}
@@ -0,0 +1,269 @@
+/**
+ * @file trig.c
+ * Trigonometry in degrees.
+ *
+ * Sine, cosine, arc tangent and arc sine evaluated with polynomial kernels
+ * written without branches, so that the batch loops can be vectorized by the
+ * compiler. Arguments are reduced in degrees, exactly, before the conversion
+ * to radians, so that large arguments (e.g. periodic terms multiplied by
+ * time) lose no accuracy. Results are within a few units in the last place
+ * of the libm functions, that is well below 1e-12 degree.
+ *
+ * The scalar functions m_sind (), m_cosd ()... replace sin (deg_to_rad (x))
+ * and friends in the library.
+ */
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include "meeus.h"
+
+#define TRIG_DEG_TO_RAD 0.017453292519943295769
+#define TRIG_RAD_TO_DEG 57.295779513082320877
+#define TRIG_SQRT3 1.7320508075688772935
+/* tan (15 degrees) */
+#define TRIG_TAN_PI_12 0.26794919243112270647
+
+/* Taylor series of sin (t) / t, cos (t) and atan (u) / u in powers of t^2 (u^2) */
+static const double trig_sin_coef[] = {
+    1.0, -1.0 / 6, 1.0 / 120, -1.0 / 5040, 1.0 / 362880, -1.0 / 39916800,
+    1.0 / 6227020800.0, -1.0 / 1307674368000.0
+};
+
+static const double trig_cos_coef[] = {
+    1.0, -1.0 / 2, 1.0 / 24, -1.0 / 720, 1.0 / 40320, -1.0 / 3628800,
+    1.0 / 479001600.0, -1.0 / 87178291200.0, 1.0 / 20922789888000.0
+};
+
+static const double trig_atan_coef[] = {
+    1.0, -1.0 / 3, 1.0 / 5, -1.0 / 7, 1.0 / 9, -1.0 / 11, 1.0 / 13,
+    -1.0 / 15, 1.0 / 17, -1.0 / 19, 1.0 / 21, -1.0 / 23, 1.0 / 25, -1.0 / 27
+};
+
+#define TRIG_N(c) ((int) ((sizeof c) / (sizeof *c)))
+
+/**
+ * @brief Horner evaluation of a polynomial with a constant number of terms
+ *
+ * @param[in] coef coefficients, constant term first
+ * @param[in] n number of coefficients
+ * @param[in] v variable
+ *
+ * @return polynomial value
+ */
+static inline double
+trig_horner (const double *coef, int n, double v)
+{
+    double r = coef[n - 1];
+    for (int i = n - 2; i >= 0; i--)
+        r = r * v + coef[i];
+    return r;
+}
+
+/**
+ * @brief sine and cosine of an angle in degrees
+ *
+ * The argument is reduced to [-45, 45] degrees around a multiple of 90 degrees.
+ * The reduction is exact for |x| < 1e14 degrees. Truncation error of the
+ * series is below 1e-17 on [-pi/4, pi/4].
+ *
+ * @param[in] x angle in degrees
+ * @param[out] s sine of x
+ * @param[out] c cosine of x
+ */
+static inline void
+trig_sincosd_kernel (double x, double *s, double *c)
+{
+    double q = floor (x * (1.0 / 90.0) + 0.5);
+    double t = (x - 90.0 * q) * TRIG_DEG_TO_RAD;
+    double t2 = t * t;
+    /* quadrant, 0 to 3 */
+    double k = q - 4.0 * floor (q * 0.25);
+    double ps = t * trig_horner (trig_sin_coef, TRIG_N (trig_sin_coef), t2);
+    double pc = trig_horner (trig_cos_coef, TRIG_N (trig_cos_coef), t2);
+    int swap = k - 2.0 * floor (k * 0.5) != 0.0;
+    double sign_s = k >= 2.0 ? -1.0 : 1.0;
+    double sign_c = fabs (k - 1.5) < 1.0 ? -1.0 : 1.0;
+
+    *s = sign_s * (swap ? pc : ps);
+    *c = sign_c * (swap ? ps : pc);
+}
+
+/**
+ * @brief arc tangent of y/x in degrees, in the quadrant of (x, y)
+ *
+ * The ratio is reduced to [0, 1], then to [-tan (15), tan (15)] degrees with
+ * atan (z) = 30 + atan ((z * sqrt (3) - 1) / (z + sqrt (3))). Truncation
+ * error of the series is below 1e-17 on that interval.
+ *
+ * @param[in] y ordinate
+ * @param[in] x abscissa
+ *
+ * @return angle between -180 and 180 degrees
+ */
+static inline double
+trig_atan2d_kernel (double y, double x)
+{
+    double ax = fabs (x), ay = fabs (y);
+    /* selects rather than fmax/fmin, which do not vectorize */
+    int swap = ay > ax;
+    double mx = swap ? ay : ax, mn = swap ? ax : ay;
+    double z = mn / (mx > 0 ? mx : 1.0);
+    int big = z > TRIG_TAN_PI_12;
+    double u = (big ? z * TRIG_SQRT3 - 1 : z) / (big ? z + TRIG_SQRT3 : 1.0);
+    double p = u * trig_horner (trig_atan_coef, TRIG_N (trig_atan_coef),
+                                u * u);
+    double r = p * TRIG_RAD_TO_DEG + (big ? 30.0 : 0.0);
+
+    r = swap ? 90.0 - r : r;
+    r = copysign (1.0, x) < 0 ? 180.0 - r : r;
+    return copysign (r, y);
+}
+
+/**
+ * @brief arc sine in degrees
+ *
+ * @param[in] x sine, between -1 and 1
+ *
+ * @return angle between -90 and 90 degrees
+ */
+static inline double
+trig_asind_kernel (double x)
+{
+    return trig_atan2d_kernel (x, sqrt ((1 - x) * (1 + x)));
+}
+
+/**
+ * @brief sine and cosine of an array of angles in degrees
+ *
+ * @param[in] x angles in degrees
+ * @param[in] n number of angles
+ * @param[out] s sines
+ * @param[out] c cosines
+ */
+void
+m_sincosd_batch (const double *restrict x, size_t n, double *restrict s,
+                 double *restrict c)
+{
+    for (size_t i = 0; i < n; i++)
+        trig_sincosd_kernel (x[i], s + i, c + i);
+}
+
+/**
+ * @brief arc tangent of an array of y/x in degrees
+ *
+ * @param[in] y ordinates
+ * @param[in] x abscissas
+ * @param[in] n number of values
+ * @param[out] r angles between -180 and 180 degrees
+ */
+void
+m_atan2d_batch (const double *restrict y, const double *restrict x, size_t n,
+                double *restrict r)
+{
+    for (size_t i = 0; i < n; i++)
+        r[i] = trig_atan2d_kernel (y[i], x[i]);
+}
+
+/**
+ * @brief arc sine of an array of values in degrees
+ *
+ * @param[in] x sines, between -1 and 1
+ * @param[in] n number of values
+ * @param[out] r angles between -90 and 90 degrees
+ */
+void
+m_asind_batch (const double *restrict x, size_t n, double *restrict r)
+{
+    for (size_t i = 0; i < n; i++)
+        r[i] = trig_asind_kernel (x[i]);
+}
+
+/**
+ * @brief sine and cosine of an angle in degrees
+ *
+ * The argument is first reduced modulo 360, which is exact.
+ *
+ * @param[in] x angle in degrees
+ * @param[out] s sine of x
+ * @param[out] c cosine of x
+ */
+void
+m_sincosd (double x, double *s, double *c)
+{
+    trig_sincosd_kernel (fmod (x, 360), s, c);
+}
+
+/**
+ * @brief sine of an angle in degrees
+ *
+ * @param[in] x angle in degrees
+ *
+ * @return sine of x
+ */
+double
+m_sind (double x)
+{
+    double s, c;
+
+    trig_sincosd_kernel (fmod (x, 360), &s, &c);
+    return s;
+}
+
+/**
+ * @brief cosine of an angle in degrees
+ *
+ * @param[in] x angle in degrees
+ *
+ * @return cosine of x
+ */
+double
+m_cosd (double x)
+{
+    double s, c;
+
+    trig_sincosd_kernel (fmod (x, 360), &s, &c);
+    return c;
+}
+
+/**
+ * @brief tangent of an angle in degrees
+ *
+ * @param[in] x angle in degrees
+ *
+ * @return tangent of x. Infinite for odd multiples of 90 degrees.
+ */
+double
+m_tand (double x)
+{
+    double s, c;
+
+    trig_sincosd_kernel (fmod (x, 360), &s, &c);
+    return s / c;
+}
+
+/**
+ * @brief arc tangent of y/x in degrees, in the quadrant of (x, y)
+ *
+ * @param[in] y ordinate
+ * @param[in] x abscissa
+ *
+ * @return angle between -180 and 180 degrees
+ */
+double
+m_atan2d (double y, double x)
+{
+    return trig_atan2d_kernel (y, x);
+}
+
+/**
+ * @brief arc sine in degrees
+ *
+ * @param[in] x sine, between -1 and 1
+ *
+ * @return angle between -90 and 90 degrees
+ */
+double
+m_asind (double x)
+{
+    return trig_asind_kernel (x);
+}
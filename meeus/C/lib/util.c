@@ -35,6 +35,16 @@ s_to_hms (double seconds, int *h, int *m, double *s)
     *s = fmod (seconds, 60.0);
 }
 
+double
+interp4 (const double *y, double x)
+{
+    /* Lagrange coefficients of the values at -1, 0, 1 and 2 */
+    return -x * (x - 1) * (x - 2) / 6 * y[-1]
+        + (x + 1) * (x - 1) * (x - 2) / 2 * y[0]
+        - (x + 1) * x * (x - 2) / 2 * y[1]
+        + (x + 1) * x * (x - 1) / 6 * y[2];
+}
+
 double
 fround (double v, int n)
 {
@@ -8,22 +8,147 @@
 #include "meeus.h"
 #include "vsop87.h"
 
+/* Earth series truncated to the terms above 3e-7 (radians or AU) at
+   |tau| = 0.1, for M_MED_ACC: 115 terms instead of 2425. Between 1900 and
+   2100 the dropped terms sum to less than 0.61" in longitude, 0.26" in
+   latitude and 2.5e-6 AU in radius vector */
+static struct vsop_planetary_components vso_earth_med_pc = {
+    .num_series = {3, 1, 3},
+    .terms_per_series = {
+                         (int[]) {63, 4, 2},
+                         (int[]) {5},
+                         (int[]) {37, 3, 1},
+                         },
+    .coefs = *(double[][3]) {
+                             {1.75347045673, 0.00000000000, 0.00000000000},
+                             {0.03341656456, 4.66925680417, 6283.07584999140},
+                             {0.00034894275, 4.62610241759, 12566.15169998280},
+                             {0.00003417571, 2.82886579606, 3.52311834900},
+                             {0.00003497056, 2.74411800971, 5753.38488489680},
+                             {0.00003135896, 3.62767041758, 77713.77146812050},
+                             {0.00002676218, 4.41808351397, 7860.41939243920},
+                             {0.00002342687, 6.13516237631, 3930.20969621960},
+                             {0.00001273166, 2.03709655772, 529.69096509460},
+                             {0.00001324292, 0.74246356352, 11506.76976979360},
+                             {0.00000901855, 2.04505443513, 26.29831979980},
+                             {0.00001199167, 1.10962944315, 1577.34354244780},
+                             {0.00000857223, 3.50849156957, 398.14900340820},
+                             {0.00000779786, 1.17882652114, 5223.69391980220},
+                             {0.00000990250, 5.23268129594, 5884.92684658320},
+                             {0.00000753141, 2.53339053818, 5507.55323866740},
+                             {0.00000505264, 4.58292563052, 18849.22754997420},
+                             {0.00000492379, 4.20506639861, 775.52261132400},
+                             {0.00000356655, 2.91954116867, 0.06731030280},
+                             {0.00000284125, 1.89869034186, 796.29800681640},
+                             {0.00000242810, 0.34481140906, 5486.77784317500},
+                             {0.00000317087, 5.84901952218, 11790.62908865880},
+                             {0.00000271039, 0.31488607649, 10977.07880469900},
+                             {0.00000206160, 4.80646606059, 2544.31441988340},
+                             {0.00000205385, 1.86947813692, 5573.14280143310},
+                             {0.00000202261, 2.45767795458, 6069.77675455340},
+                             {0.00000126184, 1.08302630210, 20.77539549240},
+                             {0.00000155516, 0.83306073807, 213.29909543800},
+                             {0.00000115132, 0.64544911683, 0.98032106820},
+                             {0.00000102851, 0.63599846727, 4694.00295470760},
+                             {0.00000101724, 4.26679821365, 7.11354700080},
+                             {0.00000099206, 6.20992940258, 2146.16541647520},
+                             {0.00000132212, 3.41118275555, 2942.46342329160},
+                             {0.00000097607, 0.68101272270, 155.42039943420},
+                             {0.00000085128, 1.29870743025, 6275.96230299060},
+                             {0.00000074651, 1.75508916159, 5088.62883976680},
+                             {0.00000101895, 0.97569221824, 15720.83878487840},
+                             {0.00000084711, 3.67080093025, 71430.69561812909},
+                             {0.00000073547, 4.67926565481, 801.82093112380},
+                             {0.00000073874, 3.50319443167, 3154.68708489560},
+                             {0.00000078756, 3.03698313141, 12036.46073488820},
+                             {0.00000079637, 1.80791330700, 17260.15465469040},
+                             {0.00000085803, 5.98322631256, 161000.68573767410},
+                             {0.00000056963, 2.78430398043, 6286.59896834040},
+                             {0.00000061148, 1.81839811024, 7084.89678111520},
+                             {0.00000069627, 0.83297596966, 9437.76293488700},
+                             {0.00000056116, 4.38694880779, 14143.49524243060},
+                             {0.00000062449, 3.97763880587, 8827.39026987480},
+                             {0.00000051145, 0.28306864501, 5856.47765911540},
+                             {0.00000055577, 3.47006009062, 6279.55273164240},
+                             {0.00000041036, 5.36817351402, 8429.24126646660},
+                             {0.00000051605, 1.33282746983, 1748.01641306700},
+                             {0.00000051992, 0.18914945834, 12139.55350910680},
+                             {0.00000049000, 0.48735065033, 1194.44701022460},
+                             {0.00000039200, 6.16832995016, 10447.38783960440},
+                             {0.00000035566, 1.77597314691, 6812.76681508600},
+                             {0.00000036770, 6.04133859347, 10213.28554621100},
+                             {0.00000036596, 2.56955238628, 1059.38193018920},
+                             {0.00000033291, 0.59309499459, 17789.84561978500},
+                             {0.00000035954, 1.70876111898, 2352.86615377180},
+                             {0.00000040938, 2.39850881707, 19651.04848109800},
+                             {0.00000030047, 2.73975123935, 1349.86740965880},
+                             {0.00000030412, 0.44294464135, 83996.84731811189},
+                             {6283.31966747491, 0.00000000000, 0.00000000000},
+                             {0.00206058863, 2.67823455584, 6283.07584999140},
+                             {0.00004303430, 2.63512650414, 12566.15169998280},
+                             {0.00000425264, 1.59046980729, 3.52311834900},
+                             {0.00052918870, 0.00000000000, 0.00000000000},
+                             {0.00008719837, 1.07209665242, 6283.07584999140},
+                             {0.00000279620, 3.19870156017, 84334.66158130829},
+                             {0.00000101643, 5.42248619256, 5507.55323866740},
+                             {0.00000080445, 3.88013204458, 5223.69391980220},
+                             {0.00000043806, 3.70444689758, 2352.86615377180},
+                             {0.00000031933, 4.00026369781, 1577.34354244780},
+                             {1.00013988799, 0.00000000000, 0.00000000000},
+                             {0.01670699626, 3.09846350771, 6283.07584999140},
+                             {0.00013956023, 3.05524609620, 12566.15169998280},
+                             {0.00003083720, 5.19846674381, 77713.77146812050},
+                             {0.00001628461, 1.17387749012, 5753.38488489680},
+                             {0.00001575568, 2.84685245825, 7860.41939243920},
+                             {0.00000924799, 5.45292234084, 11506.76976979360},
+                             {0.00000542444, 4.56409149777, 3930.20969621960},
+                             {0.00000472110, 3.66100022149, 5884.92684658320},
+                             {0.00000328780, 5.89983646482, 5223.69391980220},
+                             {0.00000345983, 0.96368617687, 5507.55323866740},
+                             {0.00000306784, 0.29867139512, 5573.14280143310},
+                             {0.00000174844, 3.01193636534, 18849.22754997420},
+                             {0.00000243189, 4.27349536153, 11790.62908865880},
+                             {0.00000211829, 5.84714540314, 1577.34354244780},
+                             {0.00000185752, 5.02194447178, 10977.07880469900},
+                             {0.00000109835, 5.05510636285, 5486.77784317500},
+                             {0.00000098316, 0.88681311277, 6069.77675455340},
+                             {0.00000086499, 5.68959778254, 15720.83878487840},
+                             {0.00000085825, 1.27083733351, 161000.68573767410},
+                             {0.00000062916, 0.92177108832, 529.69096509460},
+                             {0.00000057056, 2.01374292014, 83996.84731811189},
+                             {0.00000064903, 0.27250613787, 17260.15465469040},
+                             {0.00000049384, 3.24501240359, 2544.31441988340},
+                             {0.00000055736, 5.24159798933, 71430.69561812909},
+                             {0.00000042515, 6.01110242003, 6275.96230299060},
+                             {0.00000046963, 2.57805070386, 775.52261132400},
+                             {0.00000038968, 5.36071738169, 4694.00295470760},
+                             {0.00000044661, 5.53715807302, 9437.76293488700},
+                             {0.00000035660, 1.67468058995, 12036.46073488820},
+                             {0.00000031921, 0.18368229781, 5088.62883976680},
+                             {0.00000031846, 1.77775642085, 398.14900340820},
+                             {0.00000033193, 0.24370300098, 7084.89678111520},
+                             {0.00000038245, 2.39255343974, 8827.39026987480},
+                             {0.00000037490, 0.82952922332, 19651.04848109800},
+                             {0.00000036957, 4.90107591914, 12139.55350910680},
+                             {0.00000034537, 1.84270693282, 2942.46342329160},
+                             {0.00103018608, 1.10748969588, 6283.07584999140},
+                             {0.00001721238, 1.06442301418, 12566.15169998280},
+                             {0.00000702215, 3.14159265359, 0.00000000000},
+                             {0.00004359385, 5.78455133738, 6283.07584999140},
+                             }
+};
+
 /**
- * @brief Get planet heliocentric ecliptical coordinates
+ * @brief sum the series of a VSOP87 theory
  *
- * Implementation of the procedure described in the VSOP87 readme and Meeus chapter 32.
- * Results are returned in radians, referred to the mean dynamical ecliptic and equinox
- *
- * @param[in] jde Julian Day Ephemeris (Dynamical time)
- * @param[in] planet planet for which the calculation must be performed
- * @param[out] coord coordinates. coord[0] = L (longitude), coord[1] = B (latitude), coord[2] = R (radius vector).
+ * @param[in] vsop series
+ * @param[in] tau time in Julian millennia since J2000.0 (TD)
+ * @param[out] coord coordinates, in radians and AU
  */
-void
-vso_vsop87d_dyn_coordinates (double jde, enum planet_e planet, double *coord)
+static void
+vso_eval (const struct vsop_planetary_components *vsop, double tau,
+          double *coord)
 {
-    struct vsop_planetary_components *vsop =
-        vsop87d_planetary_components[planet];
-    double tau = get_century_since_j2000 (jde) / 10;
     double tmp_c;
     double power_tau;
     int term_start = 0, term_index = 0;
@@ -47,18 +172,31 @@ vso_vsop87d_dyn_coordinates (double jde, enum planet_e planet, double *coord)
 /**
  * @brief Get planet heliocentric ecliptical coordinates
  *
- * Implements correction in Meeus formula 32.3.
- * Results are returned in radians, referred to the mean ecliptic and equinox of the date (FK5 frame).
+ * Implementation of the procedure described in the VSOP87 readme and Meeus chapter 32.
+ * Results are returned in radians, referred to the mean dynamical ecliptic and equinox
  *
  * @param[in] jde Julian Day Ephemeris (Dynamical time)
  * @param[in] planet planet for which the calculation must be performed
  * @param[out] coord coordinates. coord[0] = L (longitude), coord[1] = B (latitude), coord[2] = R (radius vector).
  */
 void
-vso_vsop87d_coordinates (double jde, enum planet_e planet, double *coord)
+vso_vsop87d_dyn_coordinates (double jde, enum planet_e planet, double *coord)
 {
-    vso_vsop87d_dyn_coordinates (jde, planet, coord);
+    vso_eval (vsop87d_planetary_components[planet],
+              get_century_since_j2000 (jde) / 10, coord);
+}
 
+/**
+ * @brief convert dynamical coordinates in radians to FK5 coordinates in degrees
+ *
+ * Implements Meeus formula 32.3.
+ *
+ * @param[in] jde Julian Day Ephemeris (Dynamical time)
+ * @param[in,out] coord coordinates
+ */
+static void
+vso_to_fk5 (double jde, double *coord)
+{
     double L = rad_to_deg (coord[0]);
     double B = rad_to_deg (coord[1]);
 
@@ -71,8 +209,45 @@ vso_vsop87d_coordinates (double jde, enum planet_e planet, double *coord)
     coord[0] =
         rerange (L +
                  arcsec_to_deg (-0.09033 +
-                                0.03916 * (cosd (Lprime) +
-                                           sind (Lprime)) * tan (coord[1])),
+                                0.03916 * (m_cosd (Lprime) +
+                                           m_sind (Lprime)) * tan (coord[1])),
                  360.0);
-    coord[1] = B + arcsec_to_deg (0.03916 * (cosd (Lprime) - sind (Lprime)));
+    coord[1] = B + arcsec_to_deg (0.03916 * (m_cosd (Lprime) - m_sind (Lprime)));
+}
+
+/**
+ * @brief Get planet heliocentric ecliptical coordinates
+ *
+ * Implements correction in Meeus formula 32.3.
+ * Results are returned in radians, referred to the mean ecliptic and equinox of the date (FK5 frame).
+ *
+ * @param[in] jde Julian Day Ephemeris (Dynamical time)
+ * @param[in] planet planet for which the calculation must be performed
+ * @param[out] coord coordinates. coord[0] = L (longitude), coord[1] = B (latitude), coord[2] = R (radius vector).
+ */
+void
+vso_vsop87d_coordinates (double jde, enum planet_e planet, double *coord)
+{
+    vso_vsop87d_dyn_coordinates (jde, planet, coord);
+    vso_to_fk5 (jde, coord);
+}
+
+/**
+ * @brief Get Earth heliocentric ecliptical coordinates
+ *
+ * Same as vso_vsop87d_coordinates (), with the complete theory or, for
+ * M_MED_ACC, the series truncated for the years 1900 to 2100.
+ * Results are returned in degrees, referred to the mean ecliptic and equinox of the date (FK5 frame).
+ *
+ * @param[in] jde Julian Day Ephemeris (Dynamical time)
+ * @param[in] accuracy M_MED_ACC for the truncated series, otherwise the complete theory
+ * @param[out] coord coordinates. coord[0] = L (longitude), coord[1] = B (latitude), coord[2] = R (radius vector).
+ */
+void
+vso_vsop87d_earth_coordinates (double jde, m_acc_t accuracy, double *coord)
+{
+    vso_eval (accuracy == M_MED_ACC ? &vso_earth_med_pc :
+              vsop87d_planetary_components[EARTH],
+              get_century_since_j2000 (jde) / 10, coord);
+    vso_to_fk5 (jde, coord);
 }
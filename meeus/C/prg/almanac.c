@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include "meeus.h"
+
+/* Sites are read from meeus/lua/lib/astro/locations.lua:
+   ["name"] = {latitude, longitude}, in radians, longitude positive towards west */
+
+#define MAX_NAME 64
+
+int
+main (int argc, char **argv)
+{
+    char line[256], name[MAX_NAME];
+    double lat, lon, jd, jd_end, *L = NULL, *phi = NULL;
+    char **names = NULL;
+    size_t n = 0, cap = 0;
+    struct tm date = { 0 };
+    FILE *f;
+
+    if (argc < 3 || argc > 4) {
+        fprintf (stderr, "Usage: %s locations.lua year [csv|bin] > output\n",
+                 argv[0]);
+        fprintf (stderr,
+                 "Writes the daily sunrise, sunset and day length of all the locations.\n");
+        return -1;
+    }
+    f = fopen (argv[1], "r");
+    if (!f) {
+        perror (argv[1]);
+        return -1;
+    }
+    while (fgets (line, sizeof line, f))
+        if (sscanf (line, " [\"%63[^\"]\"] = {%lf, %lf}", name, &lat, &lon) ==
+            3) {
+            if (n == cap) {
+                cap = cap ? 2 * cap : 1024;
+                L = realloc (L, cap * sizeof *L);
+                phi = realloc (phi, cap * sizeof *phi);
+                names = realloc (names, cap * sizeof *names);
+                if (!L || !phi || !names) {
+                    fprintf (stderr, "Out of memory\n");
+                    return -1;
+                }
+            }
+            L[n] = rad_to_deg (lon);
+            phi[n] = rad_to_deg (lat);
+            names[n++] = strdup (name);
+        }
+    fclose (f);
+
+    date.tm_year = atoi (argv[2]) - 1900;
+    date.tm_mday = 1;
+    dt_date_to_jd (&date, &jd);
+    date.tm_year++;
+    dt_date_to_jd (&date, &jd_end);
+    int n_days = (int) (jd_end - jd);
+    alm_format_t format = argc == 4
+        && !strcmp (argv[3], "bin") ? ALM_BIN : ALM_CSV;
+    if (alm_generate (jd, n_days, L, phi, (const char *const *) names, n,
+                      RST_SUN_ALT, M_LOW_ACC, 0, format, stdout)) {
+        fprintf (stderr, "Cannot generate the almanac\n");
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+#include "meeus.h"
+
+/* 1900-01-01 and 2100-01-01, 0h TD */
+#define JDE_BEGIN 2415020.5
+#define JDE_END 2488069.5
+
+static const char *acc_name[] = { "low", "high", "medium" };
+
+/**
+ * @brief maximum error of an accuracy against M_HIGH_ACC over 1900-2100
+ *
+ * @param[in] accuracy accuracy to check
+ * @param[in] n number of dates
+ */
+void
+check_error (m_acc_t accuracy, int n)
+{
+    double err_a = 0, err_d = 0, err = 0, jde_max = 0;
+
+    for (int i = 0; i < n; i++) {
+        double jde = JDE_BEGIN + (JDE_END - JDE_BEGIN) * i / (n - 1);
+        struct sun_apparent_s ref, s;
+        sun_apparent_coord (jde, M_HIGH_ACC, &ref);
+        sun_apparent_coord (jde, accuracy, &s);
+        double da = remainder (s.alpha - ref.alpha, 360) * m_cosd (ref.delta);
+        double dd = s.delta - ref.delta;
+        err_a = fmax (err_a, fabs (da));
+        err_d = fmax (err_d, fabs (dd));
+        if (hypot (da, dd) > err) {
+            err = hypot (da, dd);
+            jde_max = jde;
+        }
+    }
+    printf ("%-6s max error: alpha cos delta %.2f\", delta %.2f\", "
+            "position %.2f\" = %.5f deg (JDE %.1f)\n", acc_name[accuracy],
+            deg_to_arcsec (err_a), deg_to_arcsec (err_d),
+            deg_to_arcsec (err), err, jde_max);
+}
+
+/**
+ * @brief time sun_apparent_coord ()
+ *
+ * @param[in] accuracy accuracy to time
+ * @param[in] n number of calls
+ *
+ * @return time per call, in microseconds
+ */
+double
+bench (m_acc_t accuracy, int n)
+{
+    struct sun_apparent_s s;
+    double sum = 0;
+    clock_t t = clock ();
+
+    for (int i = 0; i < n; i++) {
+        sun_apparent_coord (2460000.5 + i * 1e-4, accuracy, &s);
+        sum += s.alpha;
+    }
+    double us = (double) (clock () - t) / CLOCKS_PER_SEC * 1e6 / n;
+    printf ("%-6s %8.2f us per position, %9.0f positions/s (%g)\n",
+            acc_name[accuracy], us, 1e6 / us, sum / n);
+    return us;
+}
+
+int
+main (int argc, char **argv)
+{
+    int n = argc > 1 ? atoi (argv[1]) : 20000;
+
+    if (n < 2) {
+        fprintf (stderr, "Usage: %s [number of positions]\n", argv[0]);
+        return -1;
+    }
+    printf ("Apparent Sun, 1900-2100, %d dates\n", n);
+    check_error (M_MED_ACC, n);
+    check_error (M_LOW_ACC, n);
+    double high = bench (M_HIGH_ACC, n);
+    printf ("speedup: medium x%.1f, low x%.1f\n",
+            high / bench (M_MED_ACC, n), high / bench (M_LOW_ACC, n));
+    return 0;
+}
@@ -1,6 +1,6 @@
-#define _XOPEN_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <math.h>
 #include "meeus.h"
@@ -41,8 +41,8 @@ struct rythm rythms[] = {
 int
 main (int argc, char **argv)
 {
-    struct tm td;
     double jd_birth, jd_now, delta_jd;
+    size_t used;
 
     if (argc != 2) {
         printf
@@ -51,10 +51,10 @@ main (int argc, char **argv)
         return -1;
     }
 
-    strptime (argv[1], "%Y-%m-%dT%T", &td);
-    if (dt_date_to_jd (&td, &jd_birth)) {
-        printf
-            ("Cannot compute JD for birth date. Would result in negative JD\n");
+    /* the whole argument must be a date */
+    if (iso_parse (argv[1], strlen (argv[1]), &jd_birth, &used)
+        || used < strlen (argv[1])) {
+        printf ("Cannot parse birth date %s\n", argv[1]);
         return -1;
     }
     dt_get_current_jd (0, &jd_now);
@@ -1,4 +1,7 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include <time.h>
 #include <math.h>
 #include "meeus.h"
@@ -27,6 +30,16 @@ test_datetime (void)
             td.tm_mday, td.tm_hour, td.tm_min, td.tm_sec, td.tm_yday);
     printf ("Current JD: %f\n", jd);
 
+    printf ("Current JD - two-part JD matches JD - ");
+    struct dt_jd2_s jd2_now;
+    struct dt_clock_s clk;
+    dt_get_current_jd2 (1, &jd2_now);
+    res (jd2_now.day + jd2_now.frac, jd, 3, 0);
+    printf ("Current JD - monotonic clock matches JD - ");
+    dt_clock_init (&clk, 1, 60);
+    dt_clock_get_jd2 (&clk, &jd2_now);
+    res (jd2_now.day + jd2_now.frac, jd, 3, 0);
+
     printf ("Meeus -  7.a - ");
     td = (struct tm) { 0, 29, 19, 4, 9, 57, 0, 0, 0 };
     dt_date_to_jd (&td, &jd);
@@ -57,6 +70,55 @@ test_datetime (void)
     dt_date_to_jd (&td, &jd);
     res (jd, 2446470.5, 1, 0);
 
+    printf ("Meeus -  7.a/7.b (batch) - ");
+    double bjd[3];
+    unsigned char berr[3];
+    int by[3], bm[3], bd[3];
+    double bs[3];
+    dt_date_to_jd_batch ((int[]) { 1957, 333, 2021 }, (int[]) { 10, 1, 2 },
+                         (int[]) { 4, 27, 29 },
+                         (double[]) { 0.81 * DT_SECS_PER_DAY, 43200, 0 },
+                         3, bjd, berr);
+    res_coord ((double[]) { bjd[0], bjd[1], berr[2] },
+               (double[]) { 2436116.31, 1842713.0, M_INVALID_RANGE_ERR }, 2,
+               0);
+
+    /* garbage is flagged, without overflow in the computation of the key */
+    printf ("Meeus -  7.a/7.b (batch - garbage years and months) - ");
+    dt_date_to_jd_batch ((int[]) { 2147483647, 2021, -2147483647 - 1 },
+                         (int[]) { 1, 2147483647, 1 }, (int[]) { 1, 1, 1 },
+                         (double[]) { 0, 0, 0 }, 3, bjd, berr);
+    res_coord ((double[]) { berr[0], berr[1], berr[2] },
+               (double[]) { M_INVALID_RANGE_ERR, M_INVALID_RANGE_ERR,
+               M_INVALID_RANGE_ERR }, 0, 0);
+
+    printf ("Meeus -  7.c (batch) - ");
+    dt_jd_to_date_batch ((double[]) { 2436116.31, 1842713.0, -1 }, 3, by, bm,
+                         bd, bs, berr);
+    res_coord ((double[]) { by[0], bm[0], bd[0] + bs[0] / DT_SECS_PER_DAY },
+               (double[]) { 1957, 10, 4.81 }, 2, 0);
+    printf ("Meeus -  7.c (batch - Julian calendar and error flag) - ");
+    res_coord ((double[]) { by[1] * 10000 + bm[1] * 100 + bd[1], bs[1],
+               berr[2] }, (double[]) { 3330127, 43200, M_INVALID_RANGE_ERR },
+               0, 0);
+
+    printf ("ISO 8601 - parse date and time - ");
+    const char *iso = "1957-10-04T19:26:24.000Z,1957-10-04T21:26:24+02:00";
+    size_t used;
+    double jd2;
+    iso_parse (iso, strlen (iso), &jd, &used);
+    iso_parse (iso + used + 1, strlen (iso) - used - 1, &jd2, NULL);
+    res_coord ((double[]) { jd, jd2, used },
+               (double[]) { 2436116.31, 2436116.31, 24 }, 6, 0);
+
+    printf ("ISO 8601 - reject invalid date - ");
+    res (iso_parse ("2021-02-29", 10, &jd, NULL), M_FORMAT_ERR, 0, 0);
+
+    printf ("ISO 8601 - format - ");
+    char buf[32];
+    iso_format (2436116.31, 3, buf, sizeof buf);
+    res (strcmp (buf, "1957-10-04T19:26:24.000Z"), 0, 0, 0);
+
     printf ("Meeus -  7.e - ");
     td = (struct tm) { 0, 0, 12, 30, 5, 54, 0, 0, 0 };
     int dowy;
@@ -137,6 +199,102 @@ test_dynamical (void)
     res (dy_get_deltaT_seconds (jd), 6146, 1, 1);
 }
 
+void
+test_eop (void)
+{
+    char txt[] = "/tmp/meeus_deltatXXXXXX";
+    char bin[] = "/tmp/meeus_eopXXXXXX";
+    char tmp[sizeof bin + 4];
+    double jd, deltaT;
+    FILE *f;
+    int fd;
+
+    fd = mkstemp (txt);
+    f = fdopen (fd, "w");
+    fprintf (f, " 2020  1  1  69.3612\n 2020  2  1  69.3752\n"
+             " 2020  3  1  69.3806\n");
+    fclose (f);
+    close (mkstemp (bin));
+
+    printf ("EOP - compile USNO deltaT file - ");
+    res (eop_compile (txt, EOP_FMT_USNO_DELTAT, 1.0, bin), M_NO_ERR, 0, 0);
+    printf ("EOP - load compiled table - ");
+    res (eop_load (bin), M_NO_ERR, 0, 0);
+
+    printf ("EOP - deltaT from table - ");
+    dt_date_to_jd (&(struct tm) { 0, 0, 0, 16, 0, 120, 0, 0, 0 }, &jd);
+    dy_set_deltaT_source (DY_SRC_TABLE);
+    res (dy_get_deltaT_seconds (jd), 69.3612 + 15 * 0.014 / 31, 6, 0);
+
+    printf ("EOP - UT1-UTC from table - ");
+    eop_get_ut1_utc_seconds (jd, &deltaT);
+    res (deltaT, 32.184 + 37 - (69.3612 + 15 * 0.014 / 31), 6, 0);
+
+    /* the loaded table is not modified: the new one replaces the file */
+    printf ("EOP - recompile over a loaded table - ");
+    f = fopen (txt, "w");
+    fprintf (f, " 2020  1  1  70.3612\n 2020  2  1  70.3752\n");
+    fclose (f);
+    eop_compile (txt, EOP_FMT_USNO_DELTAT, 1.0, bin);
+    snprintf (tmp, sizeof tmp, "%s.tmp", bin);
+    deltaT = dy_get_deltaT_seconds (jd);
+    eop_load (bin);
+    res_coord ((double[]) { deltaT, dy_get_deltaT_seconds (jd),
+               access (bin, F_OK) || !access (tmp, F_OK) },
+               (double[]) { 69.3612 + 15 * 0.014 / 31,
+               70.3612 + 15 * 0.014 / 31, 0 }, 6, 0);
+    eop_synchronize ();
+
+    printf ("EOP - polynomial outside of table - ");
+    dt_date_to_jd (&(struct tm) { 0, 0, 0, 1, 0, 130, 0, 0, 0 }, &jd);
+    deltaT = dy_get_deltaT_seconds (jd);
+    dy_set_deltaT_source (DY_SRC_POLYNOMIAL);
+    res (deltaT, dy_get_deltaT_seconds (jd), 6, 0);
+
+    eop_unload ();
+    eop_synchronize ();
+    unlink (txt);
+    unlink (bin);
+}
+
+void
+test_timescale (void)
+{
+    double jd[4] = { 2441317.0, 2457754.5 - 1e-6, 2457754.5, 2457754.5 + 1 };
+    double jde[4], back[4];
+    unsigned char err[4];
+
+    printf ("Time scales - TAI-UTC before and after 2017 leap second - ");
+    res_coord ((double[]) { ts_get_tai_utc (jd[1]), ts_get_tai_utc (jd[2]),
+               ts_get_tai_utc (2441317.5) }, (double[]) { 36, 37, 10 }, 0,
+               0);
+
+    printf ("Time scales - UTC to TT (batch) - ");
+    ts_utc_to_tt_batch (jd, 4, jde, err);
+    res_coord ((double[]) { err[0], (jde[2] - jd[2]) * DT_SECS_PER_DAY,
+               (jde[3] - jd[3]) * DT_SECS_PER_DAY },
+               (double[]) { M_INVALID_RANGE_ERR, 69.184, 69.184 }, 3, 0);
+
+    printf ("Time scales - TT to UTC (batch) - ");
+    ts_tt_to_utc_batch (jde + 1, 3, back, err);
+    res_coord (back, jd + 1, 8, 0);
+
+    /* 2016 Dec 31 23:59:60 is TAI 2017 Jan 1 0h + 36 s to 0h + 37 s */
+    double tai[3] = { 2457754.5 + 35.5 / DT_SECS_PER_DAY,
+        2457754.5 + 36.5 / DT_SECS_PER_DAY, 2457754.5 + 37.5 / DT_SECS_PER_DAY
+    }, utc[3];
+    printf ("Time scales - TAI to UTC across the 2017 leap second - ");
+    for (int i = 0; i < 3; i++)
+        ts_tai_to_utc (tai[i], &utc[i]);
+    res_coord ((double[]) { (utc[0] - 2457754.5) * DT_SECS_PER_DAY,
+               (utc[1] - 2457754.5) * DT_SECS_PER_DAY,
+               (utc[2] - 2457754.5) * DT_SECS_PER_DAY },
+               (double[]) { -0.5, 0, 0.5 }, 4, 0);
+
+    printf ("Time scales - TDB-TT at J2000 (microseconds) - ");
+    res (ts_get_tdb_tt (2451545.0) * 1e6, -96, 0, 0);
+}
+
 void
 test_sidereal (void)
 {
@@ -155,12 +313,60 @@ test_sidereal (void)
     s_to_hms (sid_t, &h, &m, &s);
     res_coord ((double[]) { h, m, s }, (double[]) { 13, 10, 46.1351 }, 4, 0);
 
+    printf ("Meeus - 12.a (mean sidereal time - timestamp) - ");
+    m_time_t t;
+    mt_from_jd (jd, &t);
+    sid_get_mean_gw_sid_time_mt (t, &sid_t);
+    s_to_hms (sid_t, &h, &m, &s);
+    res_coord ((double[]) { h, m, s }, (double[]) { 13, 10, 46.3668 }, 4, 0);
+
     printf ("Meeus - 12.b (mean sidereal time) - ");
     td = (struct tm) { 0, 21, 19, 10, 3, 87, 0, 0, 0 };
     dt_date_to_jd (&td, &jd);
     sid_get_mean_gw_sid_time (jd, &sid_t);
     s_to_hms (sid_t, &h, &m, &s);
     res_coord ((double[]) { h, m, s }, (double[]) { 8, 34, 57.0896 }, 4, 0);
+
+    printf ("Meeus - 12.b (mean sidereal time - timestamp) - ");
+    mt_from_jd (jd, &t);
+    sid_get_mean_gw_sid_time_mt (t, &sid_t);
+    s_to_hms (sid_t, &h, &m, &s);
+    res_coord ((double[]) { h, m, s }, (double[]) { 8, 34, 57.0896 }, 4, 0);
+
+    printf ("Sidereal stepper - 10 Hz over 2 hours against direct computation - ");
+    struct sid_stepper_s st;
+    double sid_m, sid_a, err_m = 0, err_a = 0;
+    m_time_t ts;
+    mt_from_jd (jd, &t);
+    sid_stepper_init (&st, t, 100000000, 3600000000000LL, 1);
+    for (int i = 0; i < 72000; i++) {
+        sid_stepper_next (&st, &ts, &sid_t);
+        if (i % 997)
+            continue;
+        sid_get_apparent_gw_sid_time_mt (ts, &sid_a);
+        err_a = fmax (err_a, fabs (remainder (sid_t - sid_a, 86400)));
+    }
+    sid_stepper_init (&st, t, 86400000000000LL / 7, 86400000000000LL * 400,
+                      0);
+    for (int i = 0; i < 10000; i++) {
+        sid_stepper_next (&st, &ts, &sid_t);
+        if (ts % (MT_NS_PER_DAY / 2) == 0)
+            continue;           /* 0h UT uses Meeus 12.2 */
+        sid_get_mean_gw_sid_time_mt (ts, &sid_m);
+        err_m = fmax (err_m, fabs (remainder (sid_t - sid_m, 86400)));
+    }
+    /* apparent within 1 ms, mean (over 4 years) within 1 microsecond */
+    res_coord ((double[]) { floor (err_a * 1e3), floor (err_m * 1e6), 0 },
+               (double[]) { 0, 0, 0 }, 0, 0);
+
+    printf ("Timestamp - exact split and date - ");
+    struct dt_jd2_s jd2 = { 2446896, 0.30625 };
+    mt_from_jd2 (&jd2, &t);
+    mt_to_jd2 (t, &jd2);
+    mt_to_date (t, &td);
+    res_coord ((double[]) { jd2.day, td.tm_hour * 10000 + td.tm_min * 100 +
+               td.tm_sec, td.tm_mday }, (double[]) { 2446896, 192100, 10 },
+               0, 0);
 }
 
 void
@@ -225,6 +431,126 @@ test_coordinates (void)
     res (A, 68.0337, 4, 0);
     printf ("Meeus - 13.b (equatorial to horizontal - altitude) - ");
     res (h, 15.1249, 4, 0);
+
+    printf ("Meeus - 13.b (equatorial to horizontal - rotation matrix) - ");
+    struct rot_mat_s r;
+    double x, y, z, xo, yo, zo;
+    rot_get_equ_to_hor (jd, L, phi, 1, &r);
+    rot_sph_to_vec (&alpha, &delta, 1, &x, &y, &z);
+    rot_apply (&r, &x, &y, &z, 1, &xo, &yo, &zo);
+    rot_vec_to_sph (&xo, &yo, &zo, 1, &A, &h);
+    res_coord ((double[]) { A, h, 0 }, (double[]) { 68.0337, 15.1249, 0 }, 4,
+               0);
+
+    printf ("Meeus - 13.a (ecliptical to horizontal - rotation matrix) - ");
+    ecl_true_obl_ecliptic (jd, &epsilon, M_HIGH_ACC);
+    coo_equ_to_ecl (alpha, delta, epsilon / 3600, &lambda, &beta);
+    rot_ecl_to_hor (epsilon / 3600, s_to_deg (sid_t) - L, phi, &r);
+    rot_sph_to_vec (&lambda, &beta, 1, &x, &y, &z);
+    rot_apply (&r, &x, &y, &z, 1, &xo, &yo, &zo);
+    rot_vec_to_sph (&xo, &yo, &zo, 1, &A, &h);
+    res_coord ((double[]) { A, h, 0 }, (double[]) { 68.0337, 15.1249, 0 }, 4,
+               0);
+
+    printf ("Meeus - 13.b (equatorial to horizontal - batch) - ");
+    double Hb[2] = { H, H }, db[2] = { delta, delta }, Ab[2], hb[2];
+    coo_get_local_hour_angle_batch (jd, L, (double[]) { alpha, alpha }, 2, Hb,
+                                    1);
+    coo_equ_to_hor_batch (Hb, db, 2, phi, Ab, hb);
+    res_coord ((double[]) { Ab[1], hb[1], Hb[1] },
+               (double[]) { 68.0337, 15.1249, 64.352133 }, 4, 0);
+
+    /* batch against scalar on a grid, away from the poles */
+    enum { NB = 600 };
+    double a1[NB], b1[NB], a2[NB], b2[NB], a3[NB], b3[NB];
+    double err = 0, e1, e2;
+    for (int i = 0; i < NB; i++) {
+        a1[i] = -725 + i * 2.41765;
+        b1[i] = -89 + fmod (i * 37.3, 178);
+    }
+    coo_equ_to_hor_batch (a1, b1, NB, phi, a2, b2);
+    coo_hor_to_equ_batch (a2, b2, NB, phi, a3, b3);
+    for (int i = 0; i < NB; i++) {
+        coo_equ_to_hor (a1[i], b1[i], phi, &e1, &e2);
+        err = fmax (err, fabs (remainder (a2[i] - e1, 360)));
+        err = fmax (err, fabs (b2[i] - e2));
+        coo_hor_to_equ (a2[i], b2[i], phi, &e1, &e2);
+        err = fmax (err, fabs (remainder (a3[i] - e1, 360)));
+        err = fmax (err, fabs (b3[i] - e2));
+    }
+    coo_equ_to_ecl_batch (a1, b1, NB, 23.44, a2, b2);
+    coo_ecl_to_equ_batch (a2, b2, NB, 23.44, a3, b3);
+    for (int i = 0; i < NB; i++) {
+        coo_equ_to_ecl (a1[i], b1[i], 23.44, &e1, &e2);
+        err = fmax (err, fabs (remainder (a2[i] - e1, 360)));
+        err = fmax (err, fabs (b2[i] - e2));
+        coo_ecl_to_equ (a2[i], b2[i], 23.44, &e1, &e2);
+        err = fmax (err, fabs (remainder (a3[i] - e1, 360)));
+        err = fmax (err, fabs (b3[i] - e2));
+    }
+    printf ("Coordinates - batch against scalar (1e-12 degree) - ");
+    res (floor (err * 1e12), 0, 0, 0);
+
+    printf ("Coordinates - observer x body matrix against scalar - ");
+    enum { NO = 37, NJ = 300 };
+    double Lo[NO], po[NO], Am[NO * NJ], hm[NO * NJ];
+    for (int i = 0; i < NO; i++) {
+        Lo[i] = -180 + i * 9.7;
+        po[i] = -88 + i * 4.8;
+    }
+    coo_equ_to_hor_matrix (jd, Lo, po, NO, a1, b1, NJ, 1, 3, Am, hm);
+    err = 0;
+    for (int i = 0; i < NO; i++)
+        for (int j = 0; j < NJ; j++) {
+            coo_get_local_hour_angle (jd, Lo[i], a1[j], &H, 1);
+            coo_equ_to_hor (H, b1[j], po[i], &e1, &e2);
+            err = fmax (err, fabs (remainder (Am[i * NJ + j] - e1, 360)));
+            err = fmax (err, fabs (hm[i * NJ + j] - e2));
+        }
+    res (err, 0, 9, 0);
+
+    printf ("Trigonometry - degrees (exact angles) - ");
+    res_coord ((double[]) { m_cosd (60), m_atan2d (1, 1), m_asind (0.5) },
+               (double[]) { 0.5, 45, 30 }, 15, 0);
+    printf ("Trigonometry - degrees (large argument) - ");
+    res (m_sind (1e15 + 30), -sin (deg_to_rad (50)), 15, 0);
+}
+
+void
+test_parallax (void)
+{
+    struct plx_site_s site;
+    double jd = 2452879.63681, L = hms_to_d (7, 47, 27);
+    double alpha = 339.530208, delta = -15.771083, H, at, dt;
+
+    printf ("Meeus - 11.a (rho sin phi', rho cos phi') - ");
+    plx_site_init (dms_to_d (33, 21, 22), 1706, &site);
+    res_coord ((double[]) { site.rho_sin, site.rho_cos, 0 },
+               (double[]) { 0.546861, 0.836339, 0 }, 6, 0);
+
+    printf ("Meeus - 40.a (topocentric right ascension and declination) - ");
+    coo_get_local_hour_angle (jd, L, alpha, &H, 1);
+    plx_equ_to_topo (&site, H, alpha, delta, 0.37276, &at, &dt);
+    res_coord ((double[]) { at, dt, 0 },
+               (double[]) { 339.5356, -15.775, 0 }, 4, 0);
+
+    printf ("Parallax - batch against scalar (1e-12 degree) - ");
+    enum { NB = 1000 };
+    double Hb[NB], ab[NB], db[NB], rb[NB], atb[NB], dtb[NB], err = 0;
+    for (int i = 0; i < NB; i++) {
+        Hb[i] = -180 + i * 0.37;
+        ab[i] = i * 0.359;
+        db[i] = -89 + i * 0.178;
+        /* Moon-like distances */
+        rb[i] = 0.0024 + i * 0.0000004;
+    }
+    plx_equ_to_topo_batch (&site, Hb, ab, db, rb, NB, atb, dtb);
+    for (int i = 0; i < NB; i++) {
+        plx_equ_to_topo (&site, Hb[i], ab[i], db[i], rb[i], &at, &dt);
+        err = fmax (err, fabs (atb[i] - at));
+        err = fmax (err, fabs (dtb[i] - dt));
+    }
+    res (floor (err * 1e12), 0, 0, 0);
 }
 
 void
@@ -244,6 +570,60 @@ test_refraction (void)
     res (R, 24.618, 3, 0);
     printf ("Meeus - 16.a (Apparent flattening of the Sun) - ");
     res ((h + R - 30) / 32, 0.871, 3, 0);
+
+    enum { N = 921 };
+    static double hs[N], P[N], T[N], Rb[N], R0b[N];
+    static struct ref_table_s tab;
+    double err = 0, err_tab = 0, err_inv = 0, err_163 = 0;
+
+    for (int i = 0; i < N; i++) {
+        hs[i] = -2 + i * 0.1;
+        P[i] = 700 + i % 400;
+        T[i] = -30 + i % 70;
+    }
+    printf ("Refraction - pressure and temperature, batch against scalar - ");
+    ref_refraction_true_to_apparent_batch (hs, P, T, N, Rb);
+    ref_refraction_apparent_to_true_batch (hs, P, T, N, R0b);
+    for (int i = 0; i < N; i++)
+        err = fmax (err, fabs (Rb[i] - ref_refraction_true_to_apparent_pt
+                               (hs[i], P[i], T[i]))
+                    + fabs (R0b[i] - ref_refraction_apparent_to_true_pt
+                            (hs[i], P[i], T[i])));
+    /* Meeus: twice the refraction at 505 millibars and -131.5 Celsius */
+    res_coord ((double[]) { floor (err * 60e9),
+               ref_refraction_true_to_apparent_pt (10, REF_STD_PRESSURE,
+                                                   REF_STD_TEMPERATURE)
+               - ref_refraction_true_to_apparent (10, 1),
+               ref_refraction_true_to_apparent_pt (10, 505, -131.5)
+               / ref_refraction_true_to_apparent (10, 1) },
+               (double[]) { 0, 0, 1 }, 9, 0);
+
+    printf ("Refraction - tables and exact inversion - ");
+    ref_table_init (1030, -15, &tab);
+    for (double ht = -2; ht <= 90; ht += 0.0037) {
+        double Rt = ref_refraction_true_to_apparent_pt (ht, 1030, -15);
+        double h0t = ht + Rt / 60;
+        err_tab = fmax (err_tab, fabs (ref_table_true_to_apparent (&tab, ht)
+                                       - Rt));
+        if (h0t <= 90)
+            err_inv = fmax (err_inv,
+                            fabs (h0t - ref_table_apparent_to_true (&tab, h0t)
+                                  / 60 - ht) * 60);
+        err_163 = fmax (err_163, fabs (h0t
+                                       - ref_refraction_apparent_to_true_pt
+                                       (h0t, 1030, -15) / 60 - ht) * 60);
+    }
+    /* less than 0.01", where Meeus 16.3 is off by seconds */
+    res_coord ((double[]) { floor (err_tab * 60e2), floor (err_inv * 60e2),
+               err_163 * 60 > 1 }, (double[]) { 0, 0, 1 }, 0, 0);
+
+    /* last node: 90 degrees, interpolated from nodes up to 90 + 2 steps */
+    printf ("Refraction - tables at the zenith - ");
+    res_coord ((double[]) { ref_table_true_to_apparent (&tab, 90),
+               ref_table_apparent_to_true (&tab, 90), REF_TABLE_N },
+               (double[]) { ref_refraction_true_to_apparent_pt (90, 1030, -15),
+               ref_refraction_true_to_apparent_pt (90, 1030, -15),
+               (90 - REF_TABLE_MIN) / REF_TABLE_STEP + 4 }, 6, 0);
 }
 
 void
@@ -301,6 +681,479 @@ test_sun (void)
     res (alpha, hms_to_d (13, 13, 30.749), 6, 1);
     printf ("Meeus - 25.b (Sun's declination - high precision) - ");
     res (delta, dms_to_d (-7, -47, -1.74), 6, 1);
+
+    struct sun_apparent_s sa, sb[3];
+    printf
+        ("Meeus - 22.a (fused apparent coordinates - nutation and obliquity) - ");
+    sun_apparent_coord (2446895.5, M_HIGH_ACC, &sa);
+    res_coord ((double[]) { sa.dpsi, sa.deps, deg_to_arcsec (sa.epsilon) },
+               (double[]) { -3.788, 9.443, 23 * 3600 + 26 * 60 + 36.850 }, 2,
+               0);
+    printf ("Meeus - 25.b (fused apparent coordinates - longitude, latitude, "
+            "obliquity) - ");
+    sun_apparent_coord (jd, M_HIGH_ACC, &sa);
+    res_coord ((double[]) { deg_to_arcsec (sa.lambda),
+               deg_to_arcsec (sa.beta), deg_to_arcsec (sa.epsilon) },
+               (double[]) { 199 * 3600 + 54 * 60 + 21.56, 0.72,
+               deg_to_arcsec (23.4401443) }, 2, 0);
+    printf ("Sun - fused apparent coordinates, batch against scalar - ");
+    sun_apparent_coord_batch ((double[]) { jd - 100, jd, jd + 100 }, 3,
+                              M_HIGH_ACC, sb);
+    res_coord ((double[]) { sb[1].alpha, sb[1].delta, sb[1].deps },
+               (double[]) { sa.alpha, sa.delta, sa.deps }, 12, 0);
+
+    /* medium accuracy: within 1 arcsecond of M_HIGH_ACC over 1900-2100 */
+    printf ("Sun - medium accuracy against high accuracy - ");
+    double err = 0;
+    for (int i = 0; i <= 500; i++) {
+        double jde = 2415020.5 + 146.098 * i;
+        sun_apparent_coord (jde, M_HIGH_ACC, &sa);
+        sun_apparent_coord (jde, M_MED_ACC, &sb[0]);
+        err = fmax (err, hypot (remainder (sb[0].alpha - sa.alpha, 360) *
+                                m_cosd (sa.delta), sb[0].delta - sa.delta));
+    }
+    res (floor (deg_to_arcsec (err)), 0, 0, 0);
+}
+
+void
+test_raster (void)
+{
+    struct ras_grid_s grid = { -85, 10, 18, -175, 25, 15 };
+    double A[18 * 15], h[18 * 15];
+    double jd, jde, alpha, delta, H, A1, h1, err = 0;
+
+    printf ("Raster - Sun altitude and azimuth against coo_equ_to_hor - ");
+    jd = 2446895.80625;
+    ras_sun_hor (&grid, jd, M_HIGH_ACC, 4, A, h);
+    jde = dy_ut_to_dt (jd);
+    sun_apparent_equatorial_coord (jde, &alpha, &delta, M_HIGH_ACC);
+    for (int i = 0; i < grid.nlat; i++)
+        for (int j = 0; j < grid.nlon; j++) {
+            coo_get_local_hour_angle (jd, grid.lon0 + j * grid.dlon, alpha,
+                                      &H, 1);
+            coo_equ_to_hor (H, delta, grid.lat0 + i * grid.dlat, &A1, &h1);
+            err = fmax (err, fabs (remainder (A[i * grid.nlon + j] - A1, 360)));
+            err = fmax (err, fabs (h[i * grid.nlon + j] - h1));
+        }
+    res (err, 0, 9, 0);
+}
+
+void
+test_irradiance (void)
+{
+    const double L = -7.27, phi = 43.7, height = 150;
+    const size_t nt = 3 * 1440;     /* 3 days, one minute steps */
+    struct irr_sun_s *sun = malloc (nt * sizeof *sun);
+    struct plx_site_s site;
+    double err = 0;
+
+    printf ("Irradiance - Sun vectors against separate calls - ");
+    irr_sun (2460480.25, 1.0 / 1440, nt, L, phi, height, M_HIGH_ACC, 0, sun);
+    plx_site_init (phi, height, &site);
+    for (size_t i = 0; i < nt; i += 37) {
+        double jd = 2460480.25 + i / 1440.0, H, at, dt, A, h;
+        struct sun_apparent_s s;
+        sun_apparent_coord (dy_ut_to_dt (jd), M_HIGH_ACC, &s);
+        coo_get_local_hour_angle (jd, L, s.alpha, &H, 1);
+        plx_equ_to_topo (&site, H, s.alpha, s.delta, s.R, &at, &dt);
+        coo_equ_to_hor (H - (at - s.alpha), dt, phi, &A, &h);
+        if (h >= -1)
+            h += ref_refraction_true_to_apparent (h, 1) / 60;
+        double v[3] = { m_cosd (h) * m_cosd (A), m_cosd (h) * m_sind (A),
+            m_sind (h)
+        };
+        err = fmax (err, hypot (hypot (v[0] - sun[i].s[0],
+                                       v[1] - sun[i].s[1]),
+                                v[2] - sun[i].s[2]));
+        err = fmax (err, fabs (sun[i].h - h) / 180 * M_PI);
+    }
+    /* less than 0.01" */
+    res (floor (rad_to_deg (err) * 3600e2), 0, 0, 0);
+
+    printf ("Irradiance - air mass and extraterrestrial irradiance - ");
+    int ok = 1;
+    for (size_t i = 0; i < nt; i++) {
+        /* June: about 1316 W/m2 at aphelion */
+        ok &= sun[i].E0 > 1316 && sun[i].E0 < 1320;
+        ok &= sun[i].h > 0 ? sun[i].air_mass >= 1
+            && sun[i].air_mass < 40 : isnan (sun[i].air_mass);
+    }
+    res (ok, 1, 0, 0);
+
+    /* panels: horizontal, facing the Sun at the first time, and random */
+    const size_t np = 700;
+    double *n = malloc (3 * np * sizeof *n);
+    double *c = malloc (2 * nt * np * sizeof *c), *q = c + nt * np;
+    irr_panel_normal (0, 0, n);
+    for (int k = 0; k < 3; k++)
+        n[3 + k] = sun[0].s[k];
+    for (size_t p = 2; p < np; p++)
+        irr_panel_normal (p % 90, p * 7.3, n + 3 * p);
+    printf ("Irradiance - incidence and plane of array irradiance - ");
+    irr_incidence (sun, nt, n, np, 0, c, q);
+    err = fabs (c[0] - sun[0].s[2]) + fabs (c[1] - 1);
+    for (size_t t = 0; t < nt; t += 11)
+        for (size_t p = 0; p < np; p += 3) {
+            double d = sun[t].s[0] * n[3 * p] + sun[t].s[1] * n[3 * p + 1]
+                + sun[t].s[2] * n[3 * p + 2];
+            double e = sun[t].h > 0 && d > 0 ? sun[t].E0 * d : 0;
+            err = fmax (err, fabs (c[t * np + p] - d) +
+                        fabs (q[t * np + p] - e) / 1361);
+        }
+    res (floor (err * 1e12), 0, 0, 0);
+
+    printf ("Irradiance - Sun out of range - ");
+    res (irr_sun (2451545.0 - 3652500 - 10, 1.0 / 1440, nt, L, phi, height,
+                  M_HIGH_ACC, 0, sun), M_INVALID_RANGE_ERR, 0, 0);
+    free (n);
+    free (c);
+    free (sun);
+}
+
+void
+test_horizon (void)
+{
+    /* a whole year, both ends included: the last time falls on a Sun node */
+    enum { N = 200, BINS = 360, NT = 365 * 72 + 1 };
+    const double L = -6, phi = 45, height = 2, jd = 2460676.5, step = 1 / 72.;
+    struct hzn_dem_s dem;
+    float p[BINS];
+    unsigned char *mask = malloc (NT);
+    double err = 0;
+    int shaded = 0;
+    FILE *f = tmpfile ();
+
+    /* plain at 0 m, 5.9-6.1 E, 44.9-45.1 N, and a 500 m ridge 44.95-44.96 N.
+       A void at 44.98 N, between the site and the ridge */
+    fprintf (f, "ncols %d\nnrows %d\nxllcorner 5.9\nyllcorner 44.9\n"
+             "cellsize 0.001\nNODATA_value -9999\n", N, N);
+    for (int i = 0; i < N; i++)
+        for (int j = 0; j < N; j++)
+            fprintf (f, "%d%c", i == 119 && (j == 99 || j == 100) ? -9999
+                     : i >= N - 60 && i < N - 50 ? 500 : 0,
+                     j < N - 1 ? ' ' : '\n');
+    rewind (f);
+    printf ("Horizon - elevation raster - ");
+    hzn_dem_read (f, &dem);
+    fclose (f);
+    res_coord ((double[]) { dem.ncols, dem.zmax,
+               hzn_dem_elevation (&dem, 6, 44.955), hzn_dem_elevation (&dem,
+                                                                       6.2,
+                                                                       45) },
+               (double[]) { N, 500, 500, NAN }, 6, 0);
+
+    /* ridge at 4503 m, lowered by 1.38 m by the curvature; flat to the north */
+    printf ("Horizon - profiles against the geometry - ");
+    hzn_profiles (&dem, &L, &phi, &height, 1, BINS, 20000, 0, p);
+    res_coord ((double[]) { round (p[0] * 10), round (p[180] * 100),
+               p[90] < 0 },
+               (double[]) { round (rad_to_deg (atan (496.62 / 4503)) * 10),
+               -4, 1 }, 0, 0);
+
+    printf ("Horizon - Sun masks against separate calls - ");
+    hzn_sun_masks (p, BINS, &L, &phi, 1, jd, step, NT, M_HIGH_ACC, 0, mask);
+    for (size_t i = 0; i < NT; i += 8) {
+        double t = jd + i * step, alpha, delta, H, A, h;
+        sun_apparent_equatorial_coord (dy_ut_to_dt (t), &alpha, &delta,
+                                       M_HIGH_ACC);
+        coo_get_local_hour_angle (t, L, alpha, &H, 1);
+        coo_equ_to_hor (H, delta, phi, &A, &h);
+        if (h >= -1)
+            h += ref_refraction_true_to_apparent (h, 1) / 60;
+        int lit = h > 0 && !hzn_is_shaded (p, BINS, A, h);
+        /* only a few arc seconds from the horizon or the terrain */
+        if (lit != mask[i])
+            err = fmax (err, fmin (fabs (h), fabs (h - p[(int) rerange (A, 360)])));
+        shaded += h > 0 && !mask[i];
+    }
+    res_coord ((double[]) { floor (err * 3600 / 10), shaded > 0, mask[0] },
+               (double[]) { 0, 1, 0 }, 0, 0);
+
+    printf ("Horizon - Sun masks without azimuth bin - ");
+    res (hzn_sun_masks (p, 0, &L, &phi, 1, jd, step, NT, M_HIGH_ACC, 0,
+                        mask), M_INVALID_RANGE_ERR, 0, 0);
+    hzn_dem_free (&dem);
+    free (mask);
+}
+
+/* apparent altitude of the Sun, without refraction, and its hour angle */
+static double
+sun_altitude (double jd, double L, double phi, double *H)
+{
+    double alpha, delta, A, h;
+
+    sun_apparent_equatorial_coord (dy_ut_to_dt (jd), &alpha, &delta,
+                                   M_HIGH_ACC);
+    coo_get_local_hour_angle (jd, L, alpha, H, 1);
+    coo_equ_to_hor (*H, delta, phi, &A, &h);
+    return h;
+}
+
+void
+test_riseset (void)
+{
+    const double h0[] = { RST_SUN_ALT, RST_CIVIL_ALT, RST_NAUTICAL_ALT,
+        RST_ASTRONOMICAL_ALT
+    };
+    struct rst_ephem_s e;
+    struct rst_event_s ev[5];
+    double transit[2], L = 77.0656, phi = 38.9214, H, err = 0;
+    int count = 0;
+
+    printf ("Rise/set - Sun altitude and hour angle at the events (arcsecond) - ");
+    rst_sun_ephem_init (2459000.5, M_HIGH_ACC, &e);
+    for (int d = 0; d < 30; d++, rst_sun_ephem_next (&e)) {
+        rst_get_events (&e, L, phi, h0, 4, ev);
+        for (int j = 0; j < 4; j++) {
+            count += ev[j].n_rise + ev[j].n_set;
+            for (int i = 0; i < ev[j].n_rise; i++)
+                err = fmax (err, fabs (sun_altitude (ev[j].rise[i], L, phi, &H) -
+                                       h0[j]));
+            for (int i = 0; i < ev[j].n_set; i++)
+                err = fmax (err, fabs (sun_altitude (ev[j].set[i], L, phi, &H) -
+                                       h0[j]));
+        }
+        count += rst_get_transit (&e, L, transit);
+        sun_altitude (transit[0], L, phi, &H);
+        err = fmax (err, fabs (remainder (H, 360)));
+    }
+    res_coord ((double[]) { count, floor (deg_to_arcsec (err)), 0 },
+               (double[]) { 30 * 9, 0, 0 }, 0, 0);
+
+    printf ("Rise/set - no event lost or repeated around 0h UT - ");
+    int n_transit = 0, n_rise = 0;
+    double first_transit = 0, first_rise = 0, last_transit = 0, last_rise = 0;
+    double gap_t = 0, gap_r = 0;
+    rst_sun_ephem_init (2459000.5, M_LOW_ACC, &e);
+    for (int d = 0; d < 400; d++, rst_sun_ephem_next (&e)) {
+        /* local noon and sunrise close to 0h UT */
+        int n = rst_get_transit (&e, 180, transit);
+        for (int i = 0; i < n; i++, n_transit++) {
+            if (last_transit)
+                gap_t = fmax (gap_t, fabs (transit[i] - last_transit - 1));
+            else
+                first_transit = transit[i];
+            last_transit = transit[i];
+        }
+        rst_get_events (&e, -90, 45, h0, 1, ev);
+        for (int i = 0; i < ev[0].n_rise; i++, n_rise++) {
+            if (last_rise)
+                gap_r = fmax (gap_r, fabs (ev[0].rise[i] - last_rise - 1));
+            else
+                first_rise = ev[0].rise[i];
+            last_rise = ev[0].rise[i];
+        }
+    }
+    /* one event a day: a lost event leaves a 2 days gap, a repeated one a 0 day gap */
+    res_coord ((double[]) { n_transit, n_rise, gap_t < 0.001 && gap_r < 0.01 },
+               (double[]) { 1 + round (last_transit - first_transit),
+               1 + round (last_rise - first_rise), 1 }, 0, 0);
+
+    printf ("Rise/set - polar day and night - ");
+    rst_sun_ephem_init (2459021.5, M_LOW_ACC, &e);
+    rst_get_events (&e, 0, 80, h0, 1, ev);
+    rst_sun_ephem_init (2459204.5, M_LOW_ACC, &e);
+    rst_get_events (&e, 0, 80, h0, 4, ev + 1);
+    res_coord ((double[]) { ev[0].state, ev[3].state, ev[4].state },
+               (double[]) { RST_ALWAYS_ABOVE, RST_ALWAYS_BELOW, RST_EVENTS },
+               0, 0);
+}
+
+void
+test_almanac (void)
+{
+    enum { NS = 3, ND = 40 };
+    const double L[NS] = { 77.0656, -18.95, 0 }, phi[NS] = { 38.9214, 69.65, 0 };
+    struct alm_rec_s rec[ND][NS];
+    struct rst_ephem_s e;
+    struct rst_event_s ev;
+    double h0 = RST_SUN_ALT, err = 0;
+    char hdr[40];
+    int read, same_events = 1;
+    FILE *f = tmpfile ();
+
+    printf ("Almanac - binary tables, same events as rst_get_events - ");
+    alm_generate (2459000.5, ND, L, phi, NULL, NS, h0, M_LOW_ACC, 2,
+                  ALM_BIN, f);
+    rewind (f);
+    read = fread (hdr, sizeof hdr, 1, f) == 1
+        && fread (rec, sizeof rec, 1, f) == 1;
+    fclose (f);
+    rst_sun_ephem_init (2459000.5, M_LOW_ACC, &e);
+    for (int d = 0; read && d < ND; d++, rst_sun_ephem_next (&e))
+        for (int i = 0; i < NS; i++) {
+            const struct alm_rec_s *r = &rec[d][i];
+            rst_get_events (&e, L[i], phi[i], &h0, 1, &ev);
+            /* a missing event is NAN in the table */
+            same_events &= isnan (r->rise) == !ev.n_rise
+                && isnan (r->set) == !ev.n_set;
+            if (ev.n_rise && !isnan (r->rise))
+                err = fmax (err, fabs ((ev.rise[0] - e.jd) * 24 - r->rise));
+            if (ev.n_set && !isnan (r->set))
+                err = fmax (err, fabs ((ev.set[0] - e.jd) * 24 - r->set));
+        }
+    /* Tromso: no sunrise during the midnight Sun */
+    res_coord ((double[]) { read, same_events,
+               read && isnan (rec[0][1].rise) },
+               (double[]) { 1, 1, 1 }, 0, 0);
+
+    printf ("Almanac - binary tables against rst_get_events - ");
+    /* Tromso: midnight Sun. Equator: 12h07 */
+    res_coord ((double[]) { floor (err * 3600), rec[0][1].length,
+               round (rec[0][2].length * 60) },
+               (double[]) { 0, 24, 12 * 60 + 7 }, 0, 0);
+}
+
+void
+test_catalog (void)
+{
+    char txt[] = "/tmp/meeus_catXXXXXX";
+    char bin[] = "/tmp/meeus_catbinXXXXXX";
+    struct cat_s cat;
+    struct cat_epoch_s ep;
+    struct rot_mat_s r;
+    double alpha[2], delta[2], x, y, z, xo, yo, zo, s;
+    double jde = 2462088.69;
+    int h, m;
+    FILE *f;
+    int fd;
+
+    /* theta Persei, Meeus 21.b and 23.a. pmra converted to mas/yr times cos (dec) */
+    fd = mkstemp (txt);
+    f = fdopen (fd, "w");
+    fprintf (f, "# id ra dec pmra pmdec mag\n"
+             "937 41.0499417 49.2284667 335.50 -89.5 4.12\n"
+             "1 0 0 0 0 0\n");
+    fclose (f);
+    close (mkstemp (bin));
+
+    printf ("Catalog - compile and open - ");
+    res_coord ((double[]) { cat_compile (txt, bin), cat_open (bin, &cat),
+               cat.count }, (double[]) { M_NO_ERR, M_NO_ERR, 2 }, 0, 0);
+
+    printf ("Meeus - 21.b (precession with proper motion) - ");
+    double t = (jde - 2451545.0) / 365.25;
+    x = cat.x[0] + t * cat.vx[0];
+    y = cat.y[0] + t * cat.vy[0];
+    z = cat.z[0] + t * cat.vz[0];
+    rot_precession (jde, &r);
+    rot_apply (&r, &x, &y, &z, 1, &xo, &yo, &zo);
+    rot_vec_to_sph (&xo, &yo, &zo, 1, alpha, delta);
+    res_coord ((double[]) { alpha[0], delta[0], 0 },
+               (double[]) { 41.547214, 49.348483, 0 }, 5, 0);
+
+    printf ("Meeus - 23.a (apparent place - right ascension) - ");
+    cat_get_epoch (jde, &ep);
+    cat_apparent_place (&cat, &ep, 2, alpha, delta);
+    s_to_hms (deg_to_s (alpha[0]), &h, &m, &s);
+    res_coord ((double[]) { h, m, s }, (double[]) { 2, 46, 14.390 }, 2, 0);
+    printf ("Meeus - 23.a (apparent place - declination) - ");
+    res (delta[0], dms_to_d (49, 21, 7.45), 4, 0);
+
+    /* the open catalog is not modified: the new one replaces the file */
+    struct cat_s cat2;
+    printf ("Catalog - recompile over an open catalog - ");
+    f = fopen (txt, "w");
+    fprintf (f, "2 10 20 0 0 1\n");
+    fclose (f);
+    cat_compile (txt, bin);
+    cat_open (bin, &cat2);
+    res_coord ((double[]) { cat.count, cat.id[0], cat2.count },
+               (double[]) { 2, 937, 1 }, 0, 0);
+    cat_close (&cat2);
+
+    cat_close (&cat);
+    unlink (txt);
+    unlink (bin);
+}
+
+void
+test_spatial (void)
+{
+    enum { N = 20000 };
+    static double x[N], y[N], z[N], xr[N], yr[N], zr[N];
+    size_t id[10], bid[10] = { 0 };
+    double c[3] = { 0.3, -0.5, 0.8 }, cr[3], sep[10];
+    struct spi_s idx;
+    struct rot_mat_s r;
+    unsigned seed = 1;
+
+    for (int i = 0; i < N; i++) {
+        double lon = (seed = seed * 1103515245 + 12345) % 36000 / 100.0;
+        double u = (seed = seed * 1103515245 + 12345) % 20001 / 10000.0 - 1;
+        rot_sph_to_vec (&lon, (double[]) { rad_to_deg (asin (u)) }, 1, x + i,
+                        y + i, z + i);
+    }
+    spi_build (x, y, z, N, &idx);
+
+    printf ("Spatial index - cone search against brute force - ");
+    size_t brute = 0;
+    double cn = sqrt (c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+    for (int i = 0; i < N; i++)
+        brute += (x[i] * c[0] + y[i] * c[1] + z[i] * c[2]) / cn >= m_cosd (7);
+    res_coord ((double[]) { spi_cone (&idx, NULL, c, 7, NULL, NULL),
+               spi_cone (&idx, NULL, c, 180, NULL, NULL), 0 },
+               (double[]) { brute, N, 0 }, 0, 0);
+
+    printf ("Spatial index - k nearest against brute force - ");
+    spi_knn (&idx, NULL, c, 10, id, sep);
+    for (int k = 0; k < 10; k++) {
+        double best = -2;
+        for (int i = 0; i < N; i++) {
+            double d = (x[i] * c[0] + y[i] * c[1] + z[i] * c[2]) / cn;
+            int taken = 0;
+            for (int l = 0; l < k; l++)
+                taken |= bid[l] == i;
+            if (!taken && d > best) {
+                best = d;
+                bid[k] = i;
+            }
+        }
+    }
+    res_coord ((double[]) { memcmp (id, bid, sizeof id), sep[0] < sep[9],
+               0 }, (double[]) { 0, 1, 0 }, 0, 0);
+
+    printf ("Spatial index - pairs within 2 degrees against brute force - ");
+    struct spi_s small;
+    spi_build (x, y, z, N / 10, &small);
+    brute = 0;
+    for (int i = 0; i < N / 10; i++)
+        for (int j = i + 1; j < N / 10; j++)
+            brute += x[i] * x[j] + y[i] * y[j] + z[i] * z[j] >= m_cosd (2);
+    res (spi_pairs (&small, 2, NULL, NULL), brute, 0, 0);
+    spi_free (&small);
+
+    printf ("Spatial index - rotated query against rotated points - ");
+    rot_precession (2451545.0 + 36525 * 3, &r);
+    rot_apply (&r, x, y, z, N, xr, yr, zr);
+    rot_apply (&r, c, c + 1, c + 2, 1, cr, cr + 1, cr + 2);
+    brute = 0;
+    for (int i = 0; i < N; i++)
+        brute += (xr[i] * cr[0] + yr[i] * cr[1] + zr[i] * cr[2]) / cn >=
+            m_cosd (3);
+    res (spi_cone (&idx, &r, cr, 3, NULL, NULL), brute, 0, 0);
+
+    printf ("Spatial index - visible objects against coo_equ_to_hor - ");
+    static size_t vid[N];
+    static double vh[N];
+    double jd = 2446896.30625, L = 77.0656, phi = 38.9214, err = 0;
+    rot_get_equ_to_hor (jd, L, phi, 0, &r);
+    size_t n = spi_visible (&idx, &r, 10, N, vid, vh);
+    brute = 0;
+    for (size_t k = 0; k < N + n; k++) {
+        size_t i = k < N ? k : vid[k - N];
+        double alpha, delta, H, A, h;
+        rot_vec_to_sph (x + i, y + i, z + i, 1, &alpha, &delta);
+        coo_get_local_hour_angle (jd, L, alpha, &H, 0);
+        coo_equ_to_hor (H, delta, phi, &A, &h);
+        if (k < N)
+            brute += h >= 10;
+        else
+            err = fmax (err, fabs (vh[k - N] - h));
+    }
+    res_coord ((double[]) { n, floor (err * 1e9), 0 },
+               (double[]) { brute, 0, 0 }, 0, 0);
+    spi_free (&idx);
 }
 
 void
@@ -326,6 +1179,97 @@ test_equation_of_time (void)
     eqt_equation_of_time (2448908.5, &eqt);
     /* Allowed to fail since we are using complete VSOP87 for sun's position */
     res (eqt, 3.427351, 6, 1);
+
+    /* Sun slow in right ascension in February: the Sun is late */
+    printf ("Equation of time (February, negative) - ");
+    eqt_equation_of_time (2460355.5, &eqt);
+    res (eqt * 4 < -14 && eqt * 4 > -15, 1, 0, 0);
+
+    /* daily table, evaluated: same values as the scalar function */
+    double e[366], d[366], e1, d1, err = 0;
+    printf ("Equation of time table (daily) - ");
+    eqt_table (2460310.5, 1, 366, M_HIGH_ACC, 0, e, d);
+    for (int i = 0; i < 366; i += 5) {
+        eqt_eot_declination (2460310.5 + i, M_HIGH_ACC, &e1, &d1);
+        err = fmax (err, fmax (fabs (e[i] - e1), fabs (d[i] - d1)));
+    }
+    res (floor (err * 1e12), 0, 0, 0);
+
+    /* hourly table, interpolated: error under 1e-5 degree. The span is a
+       whole number of days: the last sample falls on a node, and is checked */
+    size_t n = 24 * 63 + 1;
+    double *eh = malloc (2 * n * sizeof *eh), *dh = eh + n;
+    printf ("Equation of time table (hourly) - ");
+    eqt_table (2460310.5, 1.0 / 24, n, M_HIGH_ACC, 0, eh, dh);
+    err = 0;
+    for (size_t i = 0; i < n; i += 7) {
+        eqt_eot_declination (2460310.5 + i / 24.0, M_HIGH_ACC, &e1, &d1);
+        err = fmax (err, fmax (fabs (eh[i] - e1), fabs (dh[i] - d1)));
+    }
+    res (floor (err * 1e5), 0, 0, 0);
+    free (eh);
+
+    /* one day in quarters: 5 samples, the last one on a node */
+    printf ("Equation of time table (whole span) - ");
+    eqt_table (2460310.5, 0.25, 5, M_HIGH_ACC, 1, e, d);
+    eqt_eot_declination (2460311.5, M_HIGH_ACC, &e1, &d1);
+    res (floor (fmax (fabs (e[4] - e1), fabs (d[4] - d1)) * 1e5), 0, 0, 0);
+
+    /* first sample out of the range of the obliquity, last one inside */
+    printf ("Equation of time table (first sample out of range) - ");
+    res (eqt_table (2451545.0 - 3652500 - 10, 1, 366, M_HIGH_ACC, 0, e, d),
+         M_INVALID_RANGE_ERR, 0, 0);
+}
+
+void
+test_sundial (void)
+{
+    struct sdl_dial_s dial;
+    double x, y, x1, y1, e, d, err = 0;
+
+    /* horizontal dial: noon shadow towards north, of length a tan (phi - delta) */
+    printf ("Sundial - horizontal, noon - ");
+    sdl_init (46.5, 0, 0, 5, &dial);
+    sdl_shadow (&dial, 0, -11.47, &x, &y);
+    res (fabs (x) + fabs (y - 5 * m_tand (46.5 + 11.47)) < 1e-12, 1, 0, 0);
+
+    printf ("Sundial - Sun below the horizon - ");
+    res (sdl_shadow (&dial, 120, -20, &x, &y) + isnan (x), 1, 0, 0);
+
+    /* declining vertical dial: hour lines meet at the center */
+    double H[3] = { -30, 15, 45 }, delta[2] = { -20, 20 }, lx[6], ly[6];
+    printf ("Sundial - hour lines through the center - ");
+    sdl_init (40, 70, 90, 1, &dial);
+    sdl_lines (&dial, H, 3, delta, 2, lx, ly);
+    for (int i = 0; i < 3; i++)
+        if (!isnan (lx[2 * i]) && !isnan (lx[2 * i + 1]))
+            err = fmax (err, fabs ((lx[2 * i] - dial.xc) *
+                                   (ly[2 * i + 1] - dial.yc) -
+                                   (ly[2 * i] - dial.yc) *
+                                   (lx[2 * i + 1] - dial.xc)));
+    res (floor (err * 1e12), 0, 0, 0);
+
+    /* analemmas: interpolated Sun against direct evaluation */
+    double ax[73 * 12], ay[73 * 12];
+    printf ("Sundial - analemmas - ");
+    sdl_init (46.5, 10, 60, 5, &dial);
+    sdl_analemma (&dial, -13.6, 1, 2460310.5, 5, 73, 7, 1, 12, M_HIGH_ACC, 0,
+                  ax, ay);
+    err = 0;
+    for (int i = 0; i < 73; i += 3)
+        for (int j = 0; j < 12; j++) {
+            double jd = 2460310.5 + i * 5 + (7 + j - 1) / 24.0;
+            eqt_eot_declination (dy_ut_to_dt (jd), M_HIGH_ACC, &e, &d);
+            sdl_shadow (&dial, 15 * (7 + j - 1 - 12) + 13.6 + e, d, &x1, &y1);
+            if (isnan (x1) != isnan (ax[i * 12 + j]))
+                err = 1;
+            else if (!isnan (x1))
+                err = fmax (err, hypot (ax[i * 12 + j] - x1,
+                                        ay[i * 12 + j] - y1) / hypot (x1,
+                                                                      y1));
+        }
+    /* relative error: grazing shadows are very long */
+    res (floor (err * 1e5), 0, 0, 0);
 }
 
 void
@@ -352,13 +1296,24 @@ main (int argc, char **argv)
 {
     test_datetime ();
     test_dynamical ();
+    test_eop ();
+    test_timescale ();
     test_sidereal ();
     test_coordinates ();
+    test_parallax ();
     test_refraction ();
     test_ecliptic ();
     test_sun ();
+    test_raster ();
+    test_irradiance ();
+    test_horizon ();
+    test_riseset ();
+    test_almanac ();
+    test_catalog ();
+    test_spatial ();
     test_equinox ();
     test_equation_of_time ();
+    test_sundial ();
     test_kepler ();
     test_vsop87 ();
     printf ("-----------------\nTEST STATUS: %s\n",
@@ -40,8 +40,18 @@ PARSER.add_argument(
     type=float,
     default=0.0,
 )
+PARSER.add_argument(
+    "--analemma",
+    "-a",
+    help="Also compute the analemmas of the clock hours for this year",
+    type=int,
+)
 ARGS = PARSER.parse_args()
 
-SD = sundial.Sundial(**vars(ARGS))
+SD = sundial.Sundial(
+    **{k: v for k, v in vars(ARGS).items() if k != "analemma"}
+)
 SD.compute_hour_lines()
+if ARGS.analemma is not None:
+    SD.compute_analemmas(ARGS.analemma)
 print(SD)
@@ -0,0 +1,127 @@
+""" Thin ctypes binding to the sundial engine of libmeeus (meeus/C/lib/sundial.c) """
+import ctypes
+from math import isnan
+import os
+
+LIB_PATH = os.environ.get(
+    "MEEUS_LIB",
+    os.path.join(
+        os.path.dirname(os.path.abspath(__file__)),
+        "..",
+        "meeus",
+        "C",
+        "lib",
+        "libmeeus.so",
+    ),
+)
+M_HIGH_ACC = 1
+
+
+class Dial(ctypes.Structure):
+    """struct sdl_dial_s"""
+
+    _fields_ = [
+        (name, ctypes.c_double)
+        for name in ("a", "sp", "cp", "sD", "cD", "sz", "cz", "P", "xc", "yc")
+    ]
+
+
+try:
+    LIB = ctypes.CDLL(LIB_PATH)
+except OSError:  # Not built: callers fall back to pure Python
+    LIB = None
+else:
+    _DOUBLE_P = ctypes.POINTER(ctypes.c_double)
+    LIB.sdl_init.argtypes = [ctypes.c_double] * 4 + [ctypes.POINTER(Dial)]
+    LIB.sdl_init.restype = None
+    LIB.sdl_lines.argtypes = [
+        ctypes.POINTER(Dial),
+        _DOUBLE_P,
+        ctypes.c_size_t,
+        _DOUBLE_P,
+        ctypes.c_size_t,
+        _DOUBLE_P,
+        _DOUBLE_P,
+    ]
+    LIB.sdl_lines.restype = ctypes.c_int
+    LIB.sdl_analemma.argtypes = (
+        [ctypes.POINTER(Dial)]
+        + [ctypes.c_double] * 4
+        + [ctypes.c_size_t, ctypes.c_double, ctypes.c_double, ctypes.c_size_t]
+        + [ctypes.c_int, ctypes.c_int, _DOUBLE_P, _DOUBLE_P]
+    )
+    LIB.sdl_analemma.restype = ctypes.c_int
+
+
+def _dial(phi, declination, zenithal_distance, stylus_length):
+    dial = Dial()
+    LIB.sdl_init(phi, declination, zenithal_distance, stylus_length, dial)
+    return dial
+
+
+def _points(x, y, rows, columns):
+    """Split the output arrays in rows of (x, y) tuples, None without shadow"""
+    return [
+        [
+            None if isnan(x[i * columns + j]) else (x[i * columns + j], y[i * columns + j])
+            for j in range(columns)
+        ]
+        for i in range(rows)
+    ]
+
+
+def lines(phi, declination, zenithal_distance, stylus_length, hour_angles, declinations):
+    """Shadow of the stylus tip for each hour angle (rows) and Sun declination
+    (columns), all angles in degrees"""
+    n_h, n_d = len(hour_angles), len(declinations)
+    x = (ctypes.c_double * (n_h * n_d))()
+    y = (ctypes.c_double * (n_h * n_d))()
+    if LIB.sdl_lines(
+        _dial(phi, declination, zenithal_distance, stylus_length),
+        (ctypes.c_double * n_h)(*hour_angles),
+        n_h,
+        (ctypes.c_double * n_d)(*declinations),
+        n_d,
+        x,
+        y,
+    ):
+        raise MemoryError("sdl_lines")
+    return _points(x, y, n_h, n_d)
+
+
+def analemma(
+    phi,
+    declination,
+    zenithal_distance,
+    stylus_length,
+    longitude,
+    zone,
+    jd,
+    day_step,
+    n_days,
+    times,
+):
+    """Shadow of the stylus tip for each date (rows) and clock time (columns),
+    with the true Sun. longitude is positive towards east, zone is clock time
+    minus UT in hours, jd is the julian day of 0h UT of the first date, times
+    is (first, step, count) in hours"""
+    t_0, t_step, n_times = times
+    x = (ctypes.c_double * (n_days * n_times))()
+    y = (ctypes.c_double * (n_days * n_times))()
+    if LIB.sdl_analemma(
+        _dial(phi, declination, zenithal_distance, stylus_length),
+        -longitude,
+        zone,
+        jd,
+        day_step,
+        n_days,
+        t_0,
+        t_step,
+        n_times,
+        M_HIGH_ACC,
+        0,
+        x,
+        y,
+    ):
+        raise ValueError("sdl_analemma: invalid range")
+    return _points(x, y, n_days, n_times)
@@ -1,8 +1,10 @@
 #!/usr/bin/env python3
 """ Computations to create a planar sundial """
 import json
+from datetime import date
 from math import radians, cos, sin, tan, fmod, dist
 import sys
+import meeus_sundial
 
 declinations_dict = {
     -23.44: "Winter Sol.",
@@ -50,6 +52,7 @@ class Sundial:
         except ZeroDivisionError:  # Can occur if z = phi
             self.center = (0, 0)
         self.hour_lines = None
+        self.analemmas = None
 
     def compute_hour_lines(self):
         """Compute all points on the sundial
@@ -63,6 +66,26 @@ class Sundial:
         the sun never indicates the declination"""
 
         self.hour_lines = []
+        if meeus_sundial.LIB is not None:
+            lines = meeus_sundial.lines(
+                self.phi,
+                self.declination,
+                self.zenithal_distance,
+                self.stylus_length,
+                [H * 15 + fmod(self.longitude, 15) for H in range(-12, 12)],
+                declinations,
+            )
+            for line in lines:
+                self.hour_lines.append(
+                    {
+                        delta: p
+                        for delta, p in zip(declinations, line)
+                        if p is not None
+                        and dist((0, 0), p) < 30 * self.stylus_length
+                    }
+                )
+            return
+
         phi_r = radians(self.phi)
         D_r = radians(self.declination)
         z_r = radians(self.zenithal_distance)
@@ -79,6 +102,8 @@ class Sundial:
                 )
                 if Q < 0:  # Sun does not illuminate the plane for this declination
                     continue
+                if sin(phi_r) * tan(delta_r) + cos(phi_r) * cos(H_r) <= 0:
+                    continue  # Sun is below the horizon
                 Nx = cos(D_r) * sin(H_r) - sin(D_r) * (
                     sin(phi_r) * cos(H_r) - cos(phi_r) * tan(delta_r)
                 )
@@ -94,6 +119,44 @@ class Sundial:
                     H_coordinates[delta] = p
             self.hour_lines.append(H_coordinates)
 
+    def compute_analemmas(self, year, day_step=1):
+        """Compute the analemma of each clock hour for a year, with the true
+        declination and equation of time of the Sun (requires libmeeus.so).
+        Clock time is the time of the meridian used for the hour lines
+        (longitude - fmod(longitude, 15)).
+        self.analemmas has one list per hour, from 0 to 23. Each list
+        contains the (x, y) points of the dates of the year, in order.
+        Points without shadow, or too far away, are omitted."""
+        if meeus_sundial.LIB is None:
+            print(
+                f"ERROR: {meeus_sundial.LIB_PATH} not found, build it with make.",
+                file=sys.stderr,
+            )
+            sys.exit(-1)
+        jd = 1721424.5 + date(year, 1, 1).toordinal()
+        n_days = (date(year + 1, 1, 1) - date(year, 1, 1)).days
+        points = meeus_sundial.analemma(
+            self.phi,
+            self.declination,
+            self.zenithal_distance,
+            self.stylus_length,
+            self.longitude,
+            (self.longitude - fmod(self.longitude, 15)) / 15,
+            jd,
+            day_step,
+            (n_days + day_step - 1) // day_step,
+            (0, 1, 24),
+        )
+        self.analemmas = [
+            [
+                row[hour]
+                for row in points
+                if row[hour] is not None
+                and dist((0, 0), row[hour]) < 30 * self.stylus_length
+            ]
+            for hour in range(24)
+        ]
+
     def to_json(self):
         """Serialize all attributes to JSON"""
         jdict = {}
@@ -105,6 +168,7 @@ class Sundial:
             "longitude",
             "center",
             "hour_lines",
+            "analemmas",
             "P",
         ):
             jdict[attribute] = getattr(self, attribute, None)
@@ -192,6 +192,26 @@ def get_svg(s_dict, unit, max_radius):
             )
         lines_d[sundial.declinations_dict[declination]] = declination_segments
 
+    # Analemmas, as polylines of points inside the radius
+    analemmas = []
+    for hour, line in enumerate(s_dict.get("analemmas") or []):
+        line = [
+            revert_y(p)
+            for p in line
+            if max_radius is None or dist((0, 0), p) <= max_radius
+        ]
+        if len(line) < 2:
+            continue
+        analemmas.append((hour, line))
+        (minx, miny) = (
+            min(minx, *[p[0] for p in line]),
+            min(miny, *[p[1] for p in line]),
+        )
+        (maxx, maxy) = (
+            max(maxx, *[p[0] for p in line]),
+            max(maxy, *[p[1] for p in line]),
+        )
+
     # Final binding box computation
     width = maxx - minx
     height = maxy - miny
@@ -221,6 +241,7 @@ def get_svg(s_dict, unit, max_radius):
         "points": points,
         "lines_h": lines_h,
         "lines_d": lines_d,
+        "analemmas": analemmas,
         "hours_t": hours_t,
         "max_radius": max_radius,
         "show_coord": False,